@@ -0,0 +1,138 @@
+// Implementation file for the BackgroundWriter class
+
+#include "BackgroundWriter.h"
+
+//**************************************************
+// Constructor starts the thread
+//**************************************************
+BackgroundWriter::BackgroundWriter(std::ostream& stream, size_t blockSize, int blockCount)
+	: target(stream), out(this), blocks(blockCountOf(blockCount)), closed(false)
+{
+	if (blockSize == 0)
+		blockSize = DEFAULT_BLOCK_SIZE;
+	for (Block& block : blocks)
+	{
+		block.bytes.resize(blockSize);
+		block.used = 0;
+	}
+	// the first block is filled here, the others wait in the free queue
+	current = &blocks[0];
+	fullBlocks.reserve((int)blocks.size());
+	freeBlocks.reserve((int)blocks.size());
+	for (size_t i = 1; i < blocks.size(); i++)
+		freeBlocks.enqueue(&blocks[i]);
+	setp(current->bytes.data(), current->bytes.data() + blockSize);
+	failed = false;
+	finished = false;
+	thread = std::thread(&BackgroundWriter::run, this);
+}
+
+//**************************************************
+// Destructor
+//**************************************************
+BackgroundWriter::~BackgroundWriter()
+{
+	finish();
+}
+
+//**************************************************
+// finish
+//**************************************************
+bool BackgroundWriter::finish()
+{
+	if (!finished)
+	{
+		handOff();
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			closed = true;
+		}
+		queued.notify_one();
+		thread.join();
+		finished = true;
+		target.flush();
+	}
+	return !failed && target.good();
+}
+
+//**************************************************
+// overflow is called with the character that did
+// not fit in the current block
+//**************************************************
+int BackgroundWriter::overflow(int c)
+{
+	if (finished)
+		return traits_type::eof();
+	handOff();
+	if (!traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+//**************************************************
+// sync queues what is buffered, it does not wait
+// for it to be written
+//**************************************************
+int BackgroundWriter::sync()
+{
+	if (!finished)
+		handOff();
+	return failed ? -1 : 0;
+}
+
+//**************************************************
+// handOff
+//**************************************************
+void BackgroundWriter::handOff()
+{
+	current->used = pptr() - pbase();
+	if (current->used == 0)
+		return;
+	std::unique_lock<std::mutex> guard(lock);
+	fullBlocks.enqueue(current);
+	queued.notify_one();
+	// waits for the thread when every block is queued
+	returned.wait(guard, [this] { return !freeBlocks.isEmpty(); });
+	freeBlocks.dequeue(current);
+	guard.unlock();
+	setp(current->bytes.data(), current->bytes.data() + current->bytes.size());
+}
+
+//**************************************************
+// take sleeps until a block is queued or the queue
+// is closed
+//**************************************************
+bool BackgroundWriter::take(Block*& block)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	queued.wait(guard, [this] { return !fullBlocks.isEmpty() || closed; });
+	// a block queued before close is still written
+	return fullBlocks.dequeue(block);
+}
+
+//**************************************************
+// run writes the full blocks in the order they were
+// queued; after a failed write the rest are dropped
+//**************************************************
+void BackgroundWriter::run()
+{
+	Block* block;
+	while (take(block))
+	{
+		if (!failed)
+		{
+			target.write(block->bytes.data(), block->used);
+			if (!target)
+				failed = true;
+		}
+		block->used = 0;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			freeBlocks.enqueue(block);
+		}
+		returned.notify_one();
+	}
+}
@@ -0,0 +1,74 @@
+// Specification file for the BackgroundWriter class
+// An output stream whose bytes are written to another stream by a
+// background thread. Text collects in fixed blocks; a full block is
+// handed to the thread through a queue and written while the caller
+// fills the next one. A few blocks are reused, so a slow target makes
+// the caller wait instead of growing memory. One mutex guards both
+// queues; the thread and the caller sleep on a condition variable
+// while they have nothing to do.
+
+#ifndef BACKGROUND_WRITER_H
+#define BACKGROUND_WRITER_H
+#include "Queue.h"
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+class BackgroundWriter : private std::streambuf
+{
+public:
+	static const size_t DEFAULT_BLOCK_SIZE = 1 << 16;
+	static const int DEFAULT_BLOCKS = 4;
+
+	// target is only used by the background thread until finish; at
+	// least two blocks are used
+	explicit BackgroundWriter(std::ostream& target, size_t blockSize = DEFAULT_BLOCK_SIZE, int blocks = DEFAULT_BLOCKS);
+	// finishes if finish was not called
+	~BackgroundWriter();
+	BackgroundWriter(const BackgroundWriter&) = delete;
+	BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+
+	// the stream to write to
+	std::ostream& stream() { return out; }
+	// write the rest and wait for the thread, false if the target failed
+	bool finish();
+
+private:
+	struct Block
+	{
+		std::vector<char> bytes;
+		size_t used;
+	};
+
+	std::ostream& target;
+	std::ostream out;
+	std::vector<Block> blocks;
+	Queue<Block*> fullBlocks;              // to the thread
+	Queue<Block*> freeBlocks;              // back from the thread
+	bool closed;                           // no more full blocks will be queued
+	Block* current;
+	std::mutex lock;                       // guards the queues and closed
+	std::condition_variable queued;        // a full block was queued or closed was set
+	std::condition_variable returned;      // a block came back to freeBlocks
+	std::atomic<bool> failed;
+	bool finished;
+	std::thread thread;
+
+	static int blockCountOf(int blocks) { return blocks < 2 ? 2 : blocks; }
+
+	// streambuf: the put area is the current block
+	int overflow(int c) override;
+	int sync() override;
+
+	// queue the current block and take a free one
+	void handOff();
+	// wait for a full block, false once closed and fullBlocks is drained
+	bool take(Block*& block);
+	void run();
+};
+#endif
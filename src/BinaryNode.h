@@ -4,6 +4,7 @@
  
 #ifndef _BINARY_NODE
 #define _BINARY_NODE
+#include <utility>
 
 template<class ItemType>
 class BinaryNode
@@ -12,24 +13,38 @@ private:
 	ItemType              item;         // Data portion
 	BinaryNode<ItemType>* leftPtr;		// Pointer to left child
 	BinaryNode<ItemType>* rightPtr;		// Pointer to right child
+	int                   subtreeSize;	// Number of nodes in the subtree rooted here
 
 public:
 	// constructors
-	BinaryNode(const ItemType & anItem)	{item = anItem; leftPtr = 0; rightPtr = 0;}
+	BinaryNode(const ItemType & anItem) : item(anItem) {leftPtr = 0; rightPtr = 0; subtreeSize = 1;}
+	BinaryNode(ItemType && anItem) : item(std::move(anItem)) {leftPtr = 0; rightPtr = 0; subtreeSize = 1;}
+	// build the item in place from its constructor arguments
+	template<class... Args>
+	BinaryNode(std::in_place_t, Args&&... args) : item(std::forward<Args>(args)...) {leftPtr = 0; rightPtr = 0; subtreeSize = 1;}
 	BinaryNode(const ItemType & anItem, 
 		       BinaryNode<ItemType>* left, 
-			   BinaryNode<ItemType>* right) {item = anItem; leftPtr = left; rightPtr = right;}
+			   BinaryNode<ItemType>* right) : item(anItem) {leftPtr = left; rightPtr = right; updateSubtreeSize();}
 	// setters
 	void setItem(const ItemType & anItem) {item = anItem;}
+	void setItem(ItemType && anItem) {item = std::move(anItem);}
 	void setLeftPtr(BinaryNode<ItemType>* left) {leftPtr = left;}
     void setRightPtr(BinaryNode<ItemType>* right) {rightPtr = right;}
+	void setSubtreeSize(int size) {subtreeSize = size;}
+	// recompute the subtree size from the children
+	void updateSubtreeSize() {subtreeSize = 1 + sizeOf(leftPtr) + sizeOf(rightPtr);}
 	// getters
-	ItemType getItem() const	 {return item;}
+	const ItemType& getItem() const	 {return item;}
+	ItemType& getItem()	 {return item;}
 	BinaryNode<ItemType>* getLeftPtr() const  {return leftPtr;}
 	BinaryNode<ItemType>* getRightPtr() const {return rightPtr;}
+	int getSubtreeSize() const {return subtreeSize;}
 
     
     bool isLeaf() const {return (leftPtr == 0 && rightPtr == 0);}
+
+	// subtree size of a possibly empty subtree
+	static int sizeOf(const BinaryNode<ItemType>* nodePtr) {return nodePtr ? nodePtr->subtreeSize : 0;}
     
 }; 
 
@@ -7,17 +7,35 @@
 
 #include "BinaryTree.h"
 #include "BinaryNode.h"
+#include "BloomFilter.h"
+#include "EytzingerIndex.h"
 
 
 template<class ItemType>
 class BinarySearchTree : public BinaryTree<ItemType>
 {   
 private:
+	// optional filter of the keys in the tree, nullptr when disabled
+	BloomFilter* filter = nullptr;
+	// number of keys the filter was sized for
+	int filterCapacity = 0;
+	// flat read-only copy used by lookups while frozen, nullptr when thawed
+	EytzingerIndex<ItemType>* frozen = nullptr;
+
+	// copy the tree into the frozen index in sorted order
+	void rebuildFrozen();
+
+	// rebuild the filter from the tree for at least expectedItems keys
+	void rebuildFilter(int expectedItems);
+
+	// link a newly built node into the tree and update the count and filter
+	bool insertNode(BinaryNode<ItemType>* newNodePtr);
+
 	// internal insert node: insert newNode in nodePtr subtree
 	BinaryNode<ItemType>* _insert(BinaryNode<ItemType>* nodePtr, BinaryNode<ItemType>* newNode);
    
 	// internal remove node: locate and delete target node under nodePtr subtree
-	BinaryNode<ItemType>* _remove(BinaryNode<ItemType>* nodePtr, ItemType target, bool & success);
+	BinaryNode<ItemType>* _remove(BinaryNode<ItemType>* nodePtr, const ItemType & target, bool & success);
    
 	// delete target node from tree, called by internal remove node
 	BinaryNode<ItemType>* deleteNode(BinaryNode<ItemType>* targetNodePtr);
@@ -33,20 +51,59 @@ private:
    
 	// search for target node
 	BinaryNode<ItemType>* findNode(BinaryNode<ItemType>* treePtr, const ItemType & target) const;
+
+	// next node on the removal path to target, nodePtr itself if it is the target
+	BinaryNode<ItemType>* stepToward(BinaryNode<ItemType>* nodePtr, const ItemType & target) const;
    
 public:  
+	BinarySearchTree() { }
+	BinarySearchTree(const BinarySearchTree<ItemType>& tree);
+	~BinarySearchTree() { delete filter; delete frozen; }
+	BinarySearchTree<ItemType>& operator=(const BinarySearchTree<ItemType>& tree);
+	// remove every node, the filter and frozen array are emptied too
+	void clear();
+	// heap bytes held by the nodes, the filter and the frozen array
+	size_t memoryUsage() const;
+	// keep a Bloom filter of the keys so that lookups of absent keys stop early
+	void enableFilter();
+	// serve getEntry, getAllEntry and findMany from a flat array built now,
+	// for read-mostly use; a write thaws the tree, call freeze again after
+	// a batch of writes to rebuild the array
+	void freeze();
+	// drop the flat array and go back to searching the tree
+	void thaw();
+	bool isFrozen() const { return frozen != nullptr; }
 	// insert a node at the correct location
     bool insert(const ItemType & newEntry);
+	bool insert(ItemType && newEntry);
+	// build the item inside a new node from its constructor arguments and insert it
+	template<class... Args>
+	bool emplace(Args&&... args);
 	// remove a node if found
 	bool remove(const ItemType & anEntry);
 	// find a target node
 	bool getEntry(const ItemType & target, ItemType & returnedItem) const;
+	// find n targets at once, found[i] tells if results[i] was filled in;
+	// the searches of a group step down the tree together with prefetching
+	int findMany(const ItemType targets[], int n, ItemType results[], bool found[]) const;
 	// find all entry with the target node
 	bool getAllEntry(const ItemType & target, void visit(ItemType& )) const;
 	// find leftmost node
 	bool leftNode(ItemType & cool) const;
 	// find rightmost node
 	bool rightNode(ItemType& cool) const;
+	// number of entries that sort before target
+	int rank(const ItemType & target) const;
+	// find the entry at 0-based position k in sorted order
+	bool select(int k, ItemType & returnedItem) const;
+	// visit the entries on 0-based page pageNum of the sorted list with an
+	// output of any type, returns the number visited
+	template<class Output>
+	int getPage(int pageNum, int pageSize, void visit(ItemType&, Output&), Output& out) const;
+	// visit in order up to limit entries from low to high, both included (limit <= 0 for all),
+	// with an output of any type; subtrees outside the range are skipped, returns the number visited
+	template<class Output>
+	int rangeOutput(const ItemType & low, const ItemType & high, void visit(ItemType&, Output&), Output& out, int limit = 0) const;
  
 };
 
@@ -56,12 +113,22 @@ public:
 template<class ItemType>
 bool BinarySearchTree<ItemType>::insert(const ItemType & newEntry)
 {
-	BinaryNode<ItemType>* newNodePtr = new BinaryNode<ItemType>(newEntry);
-	this->rootPtr = _insert(this->rootPtr, newNodePtr);
-	this->count++;
-	return true; 
+	return insertNode(new BinaryNode<ItemType>(newEntry));
 }  
 
+template<class ItemType>
+bool BinarySearchTree<ItemType>::insert(ItemType && newEntry)
+{
+	return insertNode(new BinaryNode<ItemType>(std::move(newEntry)));
+}
+
+template<class ItemType>
+template<class... Args>
+bool BinarySearchTree<ItemType>::emplace(Args&&... args)
+{
+	return insertNode(new BinaryNode<ItemType>(std::in_place, std::forward<Args>(args)...));
+}
+
 //Removing items within a tree
 template<class ItemType>
 bool BinarySearchTree<ItemType>::remove(const ItemType & target)
@@ -71,6 +138,9 @@ bool BinarySearchTree<ItemType>::remove(const ItemType & target)
 	if (isSuccessful)
 	{
 		this->count--;
+		if (filter)
+			filter->remove(target.getHash());
+		thaw();
 	}
 	return isSuccessful; 
 }  
@@ -81,6 +151,10 @@ bool BinarySearchTree<ItemType>::getEntry(const ItemType& anEntry, ItemType & re
 {
 	bool checker = false;
 	BinaryNode<ItemType>* entry;
+	if (filter && !filter->mayContain(anEntry.getHash()))
+		return false;
+	if (frozen)
+		return frozen->find(anEntry, returnedItem);
 	entry = findNode(this->rootPtr, anEntry);
 	if (entry)
 	{
@@ -90,9 +164,66 @@ bool BinarySearchTree<ItemType>::getEntry(const ItemType& anEntry, ItemType & re
     return checker;
 }  
 
+//Finding many entries, a group of searches advances one level per round
+//and prefetches each next node, so one search's miss hides behind the others
+template<class ItemType>
+int BinarySearchTree<ItemType>::findMany(const ItemType targets[], int n, ItemType results[], bool found[]) const
+{
+	if (frozen)
+		return frozen->findMany(targets, n, results, found);
+
+	BinaryNode<ItemType>* cursor[PREFETCH_GROUP];
+	int numFound = 0;
+	for (int start = 0; start < n; start += PREFETCH_GROUP)
+	{
+		int groupSize = n - start < PREFETCH_GROUP ? n - start : PREFETCH_GROUP;
+		int active = 0;
+		for (int i = 0; i < groupSize; i++)
+		{
+			found[start + i] = false;
+			// the filter rules out keys that were never inserted
+			if (filter && !filter->mayContain(targets[start + i].getHash()))
+				cursor[i] = 0;
+			else
+			{
+				cursor[i] = this->rootPtr;
+				active++;
+			}
+		}
+		while (active > 0)
+		{
+			active = 0;
+			for (int i = 0; i < groupSize; i++)
+			{
+				BinaryNode<ItemType>* nodePtr = cursor[i];
+				if (nodePtr == 0)
+					continue;
+				if (nodePtr->getItem() == targets[start + i])
+				{
+					results[start + i] = nodePtr->getItem();
+					found[start + i] = true;
+					numFound++;
+					cursor[i] = 0;
+					continue;
+				}
+				nodePtr = nodePtr->getItem() < targets[start + i] ? nodePtr->getRightPtr() : nodePtr->getLeftPtr();
+				if (nodePtr != 0)
+				{
+					PREFETCH_READ(nodePtr);
+					active++;
+				}
+				cursor[i] = nodePtr;
+			}
+		}
+	}
+	return numFound;
+}
+
 template<class ItemType>
 bool BinarySearchTree<ItemType>::getAllEntry(const ItemType& target, void visit(ItemType&)) const
 {
+	if (frozen)
+		return frozen->findAll(target, visit) > 0;
 	// find the node
 	BinaryNode<ItemType>* entry = findNode(this->rootPtr, target);
 	// if node is found
@@ -142,137 +273,406 @@ bool BinarySearchTree<ItemType>::rightNode(ItemType& cool) const
 	return checker;
 }
 
+//Copying the nodes, then building a filter and frozen array of our own
+template<class ItemType>
+BinarySearchTree<ItemType>::BinarySearchTree(const BinarySearchTree<ItemType>& tree) : BinaryTree<ItemType>(tree)
+{
+	if (tree.filter)
+		rebuildFilter(tree.filterCapacity);
+	if (tree.frozen)
+		freeze();
+}
 
+template<class ItemType>
+BinarySearchTree<ItemType>& BinarySearchTree<ItemType>::operator=(const BinarySearchTree<ItemType>& tree)
+{
+	if (this != &tree)
+	{
+		BinaryTree<ItemType>::operator=(tree);
+		delete filter;
+		filter = nullptr;
+		filterCapacity = 0;
+		thaw();
+		if (tree.filter)
+			rebuildFilter(tree.filterCapacity);
+		if (tree.frozen)
+			freeze();
+	}
+	return *this;
+}
 
+//Removing every node
+template<class ItemType>
+void BinarySearchTree<ItemType>::clear()
+{
+	BinaryTree<ItemType>::clear();
+	if (filter)
+		filter->clear();
+	thaw();
+}
 
-//////////////////////////// private functions ////////////////////////////////////////////
+//Adding up the bytes of the nodes and the structures beside them
+template<class ItemType>
+size_t BinarySearchTree<ItemType>::memoryUsage() const
+{
+	size_t bytes = BinaryTree<ItemType>::memoryUsage();
+	if (filter)
+		bytes += filter->memoryUsage();
+	if (frozen)
+		bytes += frozen->memoryUsage();
+	return bytes;
+}
 
-//Implementation of the insert operation
+//Turning on the key filter
 template<class ItemType>
-BinaryNode<ItemType>* BinarySearchTree<ItemType>::_insert(BinaryNode<ItemType>* nodePtr,
-                                                          BinaryNode<ItemType>* newNodePtr)
+void BinarySearchTree<ItemType>::enableFilter()
 {
-	if (nodePtr == 0)
+	if (!filter)
+		rebuildFilter(this->count * 2);
+}
+
+//Freezing the tree into the flat lookup array
+template<class ItemType>
+void BinarySearchTree<ItemType>::freeze()
+{
+	if (!frozen)
+		frozen = new EytzingerIndex<ItemType>;
+	rebuildFrozen();
+}
+
+//Going back to tree lookups
+template<class ItemType>
+void BinarySearchTree<ItemType>::thaw()
+{
+	delete frozen;
+	frozen = nullptr;
+}
+
+//Counting the entries smaller than target using the subtree sizes
+template<class ItemType>
+int BinarySearchTree<ItemType>::rank(const ItemType & target) const
+{
+	int smaller = 0;
+	BinaryNode<ItemType>* nodePtr = this->rootPtr;
+	while (nodePtr != 0)
 	{
-		return newNodePtr;
+		if (nodePtr->getItem() < target)
+		{
+			// the node and its whole left subtree sort before target
+			smaller += BinaryNode<ItemType>::sizeOf(nodePtr->getLeftPtr()) + 1;
+			nodePtr = nodePtr->getRightPtr();
+		}
+		else
+		{
+			nodePtr = nodePtr->getLeftPtr();
+		}
 	}
-	else
+	return smaller;
+}
+
+//Finding the k-th smallest entry using the subtree sizes
+template<class ItemType>
+bool BinarySearchTree<ItemType>::select(int k, ItemType & returnedItem) const
+{
+	BinaryNode<ItemType>* nodePtr = this->rootPtr;
+	if (k < 0 || k >= this->count)
+		return false;
+	while (nodePtr != 0)
 	{
-		if (newNodePtr->getItem() < nodePtr->getItem())
+		int leftSize = BinaryNode<ItemType>::sizeOf(nodePtr->getLeftPtr());
+		if (k < leftSize)
 		{
-			nodePtr->setLeftPtr(_insert(nodePtr->getLeftPtr(), newNodePtr));
+			nodePtr = nodePtr->getLeftPtr();
+		}
+		else if (k == leftSize)
+		{
+			returnedItem = nodePtr->getItem();
+			return true;
 		}
 		else
 		{
-			nodePtr->setRightPtr(_insert(nodePtr->getRightPtr(), newNodePtr));
+			k -= leftSize + 1;
+			nodePtr = nodePtr->getRightPtr();
 		}
-		return nodePtr;
 	}
+	return false;
 }
 
-//Implementation for the search operation
+//Visiting one page of the sorted entries
+//Descends to the first entry of the page, then walks in order from there
 template<class ItemType>
-BinaryNode<ItemType>* BinarySearchTree<ItemType>::findNode(BinaryNode<ItemType>* nodePtr,
-                                                           const ItemType & target) const
+template<class Output>
+int BinarySearchTree<ItemType>::getPage(int pageNum, int pageSize, void visit(ItemType&, Output&), Output& out) const
 {
-	if (nodePtr == 0)
-	{
+	int visited = 0;
+	// checked in long long, the product of two ints can overflow
+	if (pageNum < 0 || pageSize <= 0 || (long long)pageNum * pageSize >= this->count)
 		return 0;
-	}
-	else
+	int k = pageNum * pageSize;
+
+	// the stack holds the nodes still to be visited in order, nearest on top
+	Stack<BinaryNode<ItemType>*> path;
+	BinaryNode<ItemType>* nodePtr = this->rootPtr;
+	while (nodePtr != 0)
 	{
-		if (nodePtr->getItem() == target)
+		int leftSize = BinaryNode<ItemType>::sizeOf(nodePtr->getLeftPtr());
+		if (k < leftSize)
 		{
-			return nodePtr;
+			path.push(nodePtr);
+			nodePtr = nodePtr->getLeftPtr();
 		}
-		if (nodePtr->getItem() < target)
+		else if (k == leftSize)
 		{
-			return findNode(nodePtr->getRightPtr(), target);
+			path.push(nodePtr);
+			break;
 		}
 		else
 		{
-			return findNode(nodePtr->getLeftPtr(), target);
+			k -= leftSize + 1;
+			nodePtr = nodePtr->getRightPtr();
 		}
 	}
+
+	while (visited < pageSize && path.pop(nodePtr))
+	{
+		ItemType item = nodePtr->getItem();
+		visit(item, out);
+		visited++;
+		for (nodePtr = nodePtr->getRightPtr(); nodePtr != 0; nodePtr = nodePtr->getLeftPtr())
+			path.push(nodePtr);
+	}
+	return visited;
 }
 
-//Implementation for the left node search
+//Visiting the entries between low and high
+//Descends to the first entry not below low, then walks in order until an entry is above high
 template<class ItemType>
-BinaryNode<ItemType>* BinarySearchTree<ItemType>::findLeftNode(BinaryNode<ItemType>* nodePtr) const
+template<class Output>
+int BinarySearchTree<ItemType>::rangeOutput(const ItemType & low, const ItemType & high, void visit(ItemType&, Output&), Output& out, int limit) const
 {
-	if (nodePtr == 0)
+	int visited = 0;
+	// the stack holds the nodes still to be visited in order, nearest on top
+	Stack<BinaryNode<ItemType>*> path;
+	BinaryNode<ItemType>* nodePtr = this->rootPtr;
+	while (nodePtr != 0)
 	{
-		return 0;
+		// the left subtree of an entry below low is below low too
+		if (nodePtr->getItem() < low)
+			nodePtr = nodePtr->getRightPtr();
+		else
+		{
+			path.push(nodePtr);
+			nodePtr = nodePtr->getLeftPtr();
+		}
+	}
+
+	while ((limit <= 0 || visited < limit) && path.pop(nodePtr))
+	{
+		if (high < nodePtr->getItem())
+			break;
+		ItemType item = nodePtr->getItem();
+		visit(item, out);
+		visited++;
+		for (nodePtr = nodePtr->getRightPtr(); nodePtr != 0; nodePtr = nodePtr->getLeftPtr())
+			path.push(nodePtr);
 	}
+	return visited;
+}
+
+
+
+
+//////////////////////////// private functions ////////////////////////////////////////////
+
+//Sizing the filter and adding every key in the tree
+template<class ItemType>
+void BinarySearchTree<ItemType>::rebuildFilter(int expectedItems)
+{
+	if (expectedItems < 16)
+		expectedItems = 16;
+	if (filter)
+		filter->reset(expectedItems);
 	else
+		filter = new BloomFilter(expectedItems);
+	filterCapacity = expectedItems;
+
+	Stack<BinaryNode<ItemType>*> nodes;
+	BinaryNode<ItemType>* nodePtr;
+	if (this->rootPtr)
+		nodes.push(this->rootPtr);
+	while (nodes.pop(nodePtr))
 	{
-		if (nodePtr->getLeftPtr() != 0)
+		filter->add(nodePtr->getItem().getHash());
+		if (nodePtr->getLeftPtr())
+			nodes.push(nodePtr->getLeftPtr());
+		if (nodePtr->getRightPtr())
+			nodes.push(nodePtr->getRightPtr());
+	}
+}
+
+//Filling the frozen array with an in-order walk of the tree
+template<class ItemType>
+void BinarySearchTree<ItemType>::rebuildFrozen()
+{
+	Stack<BinaryNode<ItemType>*> path;
+	BinaryNode<ItemType>* nodePtr = this->rootPtr;
+	auto nextInOrder = [&](ItemType& slot)
+	{
+		while (nodePtr != 0)
 		{
-			return findLeftNode(nodePtr->getLeftPtr());
+			path.push(nodePtr);
+			nodePtr = nodePtr->getLeftPtr();
 		}
+		path.pop(nodePtr);
+		slot = nodePtr->getItem();
+		nodePtr = nodePtr->getRightPtr();
+	};
+	frozen->build(this->count, nextInOrder);
+}
+
+//Linking a new node into the tree
+template<class ItemType>
+bool BinarySearchTree<ItemType>::insertNode(BinaryNode<ItemType>* newNodePtr)
+{
+	this->rootPtr = _insert(this->rootPtr, newNodePtr);
+	this->count++;
+	thaw();
+	if (filter)
+	{
+		if (this->count > filterCapacity)
+			rebuildFilter(this->count * 2);
 		else
-		{
-			return nodePtr;
-		}
+			filter->add(newNodePtr->getItem().getHash());
 	}
+	return true;
 }
 
-//Implementation for the right node search
+//Implementation of the insert operation
+//Walks down to the empty link, every node passed gains one descendant
 template<class ItemType>
-BinaryNode<ItemType>* BinarySearchTree<ItemType>::findRightNode(BinaryNode<ItemType>* nodePtr) const
+BinaryNode<ItemType>* BinarySearchTree<ItemType>::_insert(BinaryNode<ItemType>* nodePtr,
+                                                          BinaryNode<ItemType>* newNodePtr)
 {
 	if (nodePtr == 0)
+		return newNodePtr;
+
+	BinaryNode<ItemType>* pCur = nodePtr;
+	while (true)
 	{
-		return 0;
-	}
-	else
-	{
-		if (nodePtr->getRightPtr() != 0)
+		pCur->setSubtreeSize(pCur->getSubtreeSize() + 1);
+		if (newNodePtr->getItem() < pCur->getItem())
 		{
-			return findRightNode(nodePtr->getRightPtr());
+			if (pCur->getLeftPtr() == 0)
+			{
+				pCur->setLeftPtr(newNodePtr);
+				break;
+			}
+			pCur = pCur->getLeftPtr();
 		}
 		else
 		{
-			return nodePtr;
+			if (pCur->getRightPtr() == 0)
+			{
+				pCur->setRightPtr(newNodePtr);
+				break;
+			}
+			pCur = pCur->getRightPtr();
 		}
 	}
+	return nodePtr;
+}
+
+//Implementation for the search operation
+template<class ItemType>
+BinaryNode<ItemType>* BinarySearchTree<ItemType>::findNode(BinaryNode<ItemType>* nodePtr,
+                                                           const ItemType & target) const
+{
+	while (nodePtr != 0)
+	{
+		if (nodePtr->getItem() == target)
+			return nodePtr;
+		if (nodePtr->getItem() < target)
+			nodePtr = nodePtr->getRightPtr();
+		else
+			nodePtr = nodePtr->getLeftPtr();
+	}
+	return 0;
+}
+
+//Implementation for the left node search
+template<class ItemType>
+BinaryNode<ItemType>* BinarySearchTree<ItemType>::findLeftNode(BinaryNode<ItemType>* nodePtr) const
+{
+	if (nodePtr != 0)
+		while (nodePtr->getLeftPtr() != 0)
+			nodePtr = nodePtr->getLeftPtr();
+	return nodePtr;
+}
+
+//Implementation for the right node search
+template<class ItemType>
+BinaryNode<ItemType>* BinarySearchTree<ItemType>::findRightNode(BinaryNode<ItemType>* nodePtr) const
+{
+	if (nodePtr != 0)
+		while (nodePtr->getRightPtr() != 0)
+			nodePtr = nodePtr->getRightPtr();
+	return nodePtr;
+}
+
+//Choosing the child to descend to when looking for target,
+//returns nodePtr itself when it holds target
+template<class ItemType>
+BinaryNode<ItemType>* BinarySearchTree<ItemType>::stepToward(BinaryNode<ItemType>* nodePtr,
+                                                             const ItemType & target) const
+{
+	if (nodePtr->getItem() > target)
+		return nodePtr->getLeftPtr();
+	if (nodePtr->getItem() < target)
+		return nodePtr->getRightPtr();
+	// For non-primary tree deletion
+	// Check if the item's primary key is the same
+	if (nodePtr->getItem().pk == target.pk)
+		return nodePtr;
+	return nodePtr->getRightPtr();
 }
 
 
 ////////////////////////////////////////////////////////////////////////
 // The following functions will be needed for the team project
 //Implementation of the remove operation
+//The first walk finds the target and its parent, the second walk
+//only runs on success and takes the target off its ancestors' sizes
 template<class ItemType>
 BinaryNode<ItemType>* BinarySearchTree<ItemType>::_remove(BinaryNode<ItemType>* nodePtr,
-	ItemType target,
+	const ItemType & target,
 	bool& success)
 
 {
-	if (nodePtr == 0)
+	BinaryNode<ItemType>* parent = 0;
+	BinaryNode<ItemType>* pCur = nodePtr;
+	BinaryNode<ItemType>* next;
+	while (pCur != 0 && (next = stepToward(pCur, target)) != pCur)
+	{
+		parent = pCur;
+		pCur = next;
+	}
+	if (pCur == 0)
 	{
 		success = false;
-		return 0;
+		return nodePtr;
 	}
+	success = true;
 
-	if (nodePtr->getItem() > target)
-		nodePtr->setLeftPtr(_remove(nodePtr->getLeftPtr(), target, success));
-	else if (nodePtr->getItem() < target)
-		nodePtr->setRightPtr(_remove(nodePtr->getRightPtr(), target, success));
+	for (BinaryNode<ItemType>* ancestor = nodePtr; ancestor != pCur; ancestor = stepToward(ancestor, target))
+		ancestor->setSubtreeSize(ancestor->getSubtreeSize() - 1);
+
+	if (parent == 0)
+		return deleteNode(pCur);
+	if (parent->getLeftPtr() == pCur)
+		parent->setLeftPtr(deleteNode(pCur));
 	else
-	{
-		// For non-primary tree deletion
-		// Check if the item's primary key is the same
-		if (nodePtr->getItem().pk == target.pk)
-		{
-			nodePtr = deleteNode(nodePtr);
-			success = true;
-		}
-		else
-		{
-			nodePtr->setRightPtr(_remove(nodePtr->getRightPtr(), target, success));
-		}
-	}
-	return nodePtr;   
+		parent->setRightPtr(deleteNode(pCur));
+	return nodePtr;
 }  
 //Implementation of the delete operation
 template<class ItemType>
@@ -302,25 +702,31 @@ BinaryNode<ItemType>* BinarySearchTree<ItemType>::deleteNode(BinaryNode<ItemType
 	{
 		ItemType newNodeValue;
 		nodePtr->setRightPtr(removeLeftmostNode(nodePtr->getRightPtr(), newNodeValue));
-		nodePtr->setItem(newNodeValue);
+		nodePtr->setItem(std::move(newNodeValue));
+		nodePtr->updateSubtreeSize();
 		return nodePtr;
 	}  
 }  
 //Implementation to remove the left leaf
+//Every node on the way down loses one descendant
 template<class ItemType> 
 BinaryNode<ItemType>* BinarySearchTree<ItemType>::removeLeftmostNode(BinaryNode<ItemType>* nodePtr,
                                                                      ItemType & successor)
 {
-	if (nodePtr->getLeftPtr() == 0)
+	BinaryNode<ItemType>* parent = 0;
+	BinaryNode<ItemType>* pCur = nodePtr;
+	while (pCur->getLeftPtr() != 0)
 	{
-		successor = nodePtr->getItem();
-		return deleteNode(nodePtr);
+		pCur->setSubtreeSize(pCur->getSubtreeSize() - 1);
+		parent = pCur;
+		pCur = pCur->getLeftPtr();
 	}
-	else 
-	{
-		nodePtr->setLeftPtr(removeLeftmostNode(nodePtr->getLeftPtr(), successor));
-		return nodePtr;
-	}       
+	// the node is deleted next, so its item can be moved out
+	successor = std::move(pCur->getItem());
+	if (parent == 0)
+		return deleteNode(pCur);
+	parent->setLeftPtr(deleteNode(pCur));
+	return nodePtr;
 }
 
 
@@ -9,6 +9,7 @@
 #include "Queue.h"
 #include "StackADT.h"
 #include <iomanip>
+#include <cstddef>
 
 
 template<class ItemType>
@@ -21,23 +22,31 @@ protected:
 public:
 	// "admin" functions
 	BinaryTree() { rootPtr = 0; count = 0; }
-	BinaryTree(const BinaryTree<ItemType>& tree) { }
-	virtual ~BinaryTree() { }
+	BinaryTree(const BinaryTree<ItemType>& tree) { rootPtr = copyTree(tree.rootPtr); count = tree.count; }
+	virtual ~BinaryTree() { destroyTree(rootPtr); }
+	BinaryTree<ItemType>& operator=(const BinaryTree<ItemType>& tree);
 
 	// common functions for all binary trees
 	bool isEmpty() const { return count == 0; }
 	int size() const { return count; }
-	void clear() { destroyTree(rootPtr); rootPtr = 0; count = 0; }
-	void preOrder(void visit(ItemType&)) const { _preorder(visit, rootPtr); }
-	void inOrder(void visit(ItemType&)) const { _inorder(visit, rootPtr); }
-	void inOrderOutput(void visit(ItemType&, ofstream&), ofstream& outFile) const { _inorder(visit, rootPtr, outFile); }
-	void postOrder(void visit(ItemType&)) const { _postorder(visit, rootPtr); }
+	virtual void clear() { destroyTree(rootPtr); rootPtr = 0; count = 0; }
+	// heap bytes held by the tree
+	virtual size_t memoryUsage() const { return count * sizeof(BinaryNode<ItemType>); }
+	// the traversals walk with an explicit stack, so a degenerate tree cannot overflow the call stack
+	void preOrder(void visit(ItemType&)) const { _iterativePreOrder(visit, rootPtr); }
+	void inOrder(void visit(ItemType&)) const { _iterativeInOrder(visit, rootPtr); }
+	// in order, handing each item to visit with an output of any type (a file, a row writer)
+	template<class Output>
+	void inOrderOutput(void visit(ItemType&, Output&), Output& out) const { _inorder(visit, rootPtr, out); }
+	void postOrder(void visit(ItemType&)) const { _iterativePostOrder(visit, rootPtr); }
 	void breadthTrav(void visit(ItemType&)) const { _breadthTrav(visit, rootPtr); }
 	void iterativePreOrder(void visit(ItemType&)) const { _iterativePreOrder(visit, rootPtr); }
 	void iterativeInOrder(void visit(ItemType&)) const { _iterativeInOrder(visit, rootPtr); }
 	void iterativePostOrder(void visit(ItemType&)) const { _iterativePostOrder(visit, rootPtr); }
 	void print(void visit(ItemType&)) const { _print(visit, rootPtr, 0); }
-	void indentedTraversal(void visitIndented(int, ItemType&)) const { _indentedTraversal(0, visitIndented, rootPtr); }
+	// preorder handing each item's depth to visitIndented, with an output of any type
+	template<class Output>
+	void indentedTraversal(void visitIndented(int, ItemType&, Output&), Output& out) const { _indentedTraversal(0, visitIndented, rootPtr, out); }
 
 	// abstract functions to be implemented by derived class
 	virtual bool insert(const ItemType& newData) = 0;
@@ -46,85 +55,119 @@ public:
 
 private:
 	// delete all nodes from the tree
-	void destroyTree(BinaryNode<ItemType>* nodePtr);
+	static void destroyTree(BinaryNode<ItemType>* nodePtr);
+	// deep copy of the nodePtr subtree
+	static BinaryNode<ItemType>* copyTree(const BinaryNode<ItemType>* nodePtr);
 
 	// internal traverse
-	void _preorder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const;
-	void _inorder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const;
-	void _inorder(void visit(ItemType&, ofstream&), BinaryNode<ItemType>* nodePtr, ofstream& outFile) const;
-	void _postorder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const;
+	template<class Output>
+	void _inorder(void visit(ItemType&, Output&), BinaryNode<ItemType>* nodePtr, Output& out) const;
 	void _breadthTrav(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const;
 	void _iterativePreOrder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const;
 	void _iterativeInOrder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const;
 	void _iterativePostOrder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const;
-	void _indentedTraversal(int level, void visit(int, ItemType&), BinaryNode<ItemType>* nodePtr) const;
+	template<class Output>
+	void _indentedTraversal(int level, void visit(int, ItemType&, Output&), BinaryNode<ItemType>* nodePtr, Output& out) const;
 };
 
-//Destroy the entire tree
-// I have no idea how exactly I could use this as it's a private,
-// Maybe I could've added another destroy tree as a public function?
+//Assignment, copies the other tree's nodes
 template<class ItemType>
-void BinaryTree<ItemType>::destroyTree(BinaryNode<ItemType>* nodePtr)
+BinaryTree<ItemType>& BinaryTree<ItemType>::operator=(const BinaryTree<ItemType>& tree)
 {
-	if (nodePtr != 0)
+	if (this != &tree)
 	{
-		destroyTree(nodePtr->getLeftPtr());
-		destroyTree(nodePtr->getRightPtr());
-		cout << "DELETING NODE: " << nodePtr->getItem.display() << endl;
-		nodePtr = 0;
+		destroyTree(rootPtr);
+		rootPtr = copyTree(tree.rootPtr);
+		count = tree.count;
 	}
+	return *this;
 }
 
-//Preorder Traversal
+//Destroy the entire tree
+// A node with a left child is rotated right until it has none, then it is
+// deleted and the walk moves right. Each node is rotated up at most once,
+// so the teardown is O(n) with no stack, however unbalanced the tree is.
 template<class ItemType>
-void BinaryTree<ItemType>::_preorder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const
+void BinaryTree<ItemType>::destroyTree(BinaryNode<ItemType>* nodePtr)
 {
-	if (nodePtr != 0)
+	while (nodePtr != 0)
 	{
-		ItemType item = nodePtr->getItem();
-		visit(item);
-		_preorder(visit, nodePtr->getLeftPtr());
-		_preorder(visit, nodePtr->getRightPtr());
+		BinaryNode<ItemType>* leftPtr = nodePtr->getLeftPtr();
+		if (leftPtr != 0)
+		{
+			nodePtr->setLeftPtr(leftPtr->getRightPtr());
+			leftPtr->setRightPtr(nodePtr);
+			nodePtr = leftPtr;
+		}
+		else
+		{
+			BinaryNode<ItemType>* rightPtr = nodePtr->getRightPtr();
+			delete nodePtr;
+			nodePtr = rightPtr;
+		}
 	}
 }
 
-//Inorder Traversal
+//Copy the entire tree
+// Walks the source with a stack of source nodes beside a stack of their copies
 template<class ItemType>
-void BinaryTree<ItemType>::_inorder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const
+BinaryNode<ItemType>* BinaryTree<ItemType>::copyTree(const BinaryNode<ItemType>* nodePtr)
 {
-	if (nodePtr != 0)
+	if (nodePtr == 0)
+		return 0;
+
+	Stack<const BinaryNode<ItemType>*> from;
+	Stack<BinaryNode<ItemType>*> to;
+	BinaryNode<ItemType>* newRoot = new BinaryNode<ItemType>(nodePtr->getItem());
+	BinaryNode<ItemType>* copyPtr;
+	newRoot->setSubtreeSize(nodePtr->getSubtreeSize());
+	from.push(nodePtr);
+	to.push(newRoot);
+
+	while (from.pop(nodePtr))
 	{
-		_inorder(visit, nodePtr->getLeftPtr());
-		ItemType item = nodePtr->getItem();
-		visit(item);
-		_inorder(visit, nodePtr->getRightPtr());
+		to.pop(copyPtr);
+		if (nodePtr->getLeftPtr() != 0)
+		{
+			BinaryNode<ItemType>* leftCopy = new BinaryNode<ItemType>(nodePtr->getLeftPtr()->getItem());
+			leftCopy->setSubtreeSize(nodePtr->getLeftPtr()->getSubtreeSize());
+			copyPtr->setLeftPtr(leftCopy);
+			from.push(nodePtr->getLeftPtr());
+			to.push(leftCopy);
+		}
+		if (nodePtr->getRightPtr() != 0)
+		{
+			BinaryNode<ItemType>* rightCopy = new BinaryNode<ItemType>(nodePtr->getRightPtr()->getItem());
+			rightCopy->setSubtreeSize(nodePtr->getRightPtr()->getSubtreeSize());
+			copyPtr->setRightPtr(rightCopy);
+			from.push(nodePtr->getRightPtr());
+			to.push(rightCopy);
+		}
 	}
+	return newRoot;
 }
 
 //Inorder Traversal For Output
 template<class ItemType>
-void BinaryTree<ItemType>::_inorder(void visit(ItemType&, ofstream&), BinaryNode<ItemType>* nodePtr, ofstream& outFile) const
+template<class Output>
+void BinaryTree<ItemType>::_inorder(void visit(ItemType&, Output&), BinaryNode<ItemType>* nodePtr, Output& out) const
 {
-	if (nodePtr != 0)
+	Stack<BinaryNode<ItemType>*> s;
+	ItemType dummy;
+	while (!s.isEmpty() || nodePtr)
 	{
-		ItemType dummy;
-		_inorder(visit, nodePtr->getLeftPtr(), outFile);
-		dummy = nodePtr->getItem();
-		visit(dummy, outFile);
-		_inorder(visit, nodePtr->getRightPtr(), outFile);
-	}
-}
-
-//Postorder Traversal
-template<class ItemType>
-void BinaryTree<ItemType>::_postorder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const
-{
-	if (nodePtr != 0)
-	{
-		_postorder(visit, nodePtr->getLeftPtr());
-		_postorder(visit, nodePtr->getRightPtr());
-		ItemType item = nodePtr->getItem();
-		visit(item);
+		if (nodePtr != 0)
+		{
+			s.push(nodePtr);
+			nodePtr = nodePtr->getLeftPtr();
+		}
+		else
+		{
+			s.pop(nodePtr);
+			dummy = nodePtr->getItem();
+			visit(dummy, out);
+			nodePtr = nodePtr->getRightPtr();
+		}
 	}
 }
 
@@ -159,37 +202,38 @@ void BinaryTree<ItemType>::_breadthTrav(void visit(ItemType&), BinaryNode<ItemTy
 
 }
 
+// Iterative PostOrder
+// Keeps only the current path on the stack, a node is visited
+// once its right subtree is done (or it has none)
 template<class ItemType>
 void BinaryTree<ItemType>::_iterativePostOrder(void visit(ItemType&), BinaryNode<ItemType>* nodePtr) const
 {
-	if (nodePtr != 0)
+	Stack<BinaryNode<ItemType>*> s;
+	BinaryNode<ItemType>* lastVisited = 0;
+	BinaryNode<ItemType>* topNode;
+	ItemType item;
+	while (!s.isEmpty() || nodePtr)
 	{
-		Stack<BinaryNode<ItemType>*> s, output;
-		BinaryNode<ItemType>* poppedNode;
-		ItemType item;
-		s.push(nodePtr);
-
-		while (!s.isEmpty())
+		if (nodePtr != 0)
 		{
-			s.pop(poppedNode);
-			output.push(poppedNode);
-
-			if (poppedNode->getLeftPtr())
+			s.push(nodePtr);
+			nodePtr = nodePtr->getLeftPtr();
+		}
+		else
+		{
+			s.getTop(topNode);
+			if (topNode->getRightPtr() != 0 && topNode->getRightPtr() != lastVisited)
 			{
-				s.push(poppedNode->getLeftPtr());
+				nodePtr = topNode->getRightPtr();
 			}
-			if (poppedNode->getRightPtr())
+			else
 			{
-				s.push(poppedNode->getRightPtr());
+				s.pop(topNode);
+				item = topNode->getItem();
+				visit(item);
+				lastVisited = topNode;
 			}
 		}
-
-		while (!output.isEmpty())
-		{
-			output.pop(poppedNode);
-			item = poppedNode->getItem();
-			visit(item);
-		}
 	}
 }
 
@@ -250,15 +294,37 @@ void BinaryTree<ItemType>::_iterativeInOrder(void visit(ItemType&), BinaryNode<I
 	}
 }
 
+// Indented Traversal
+// Preorder with the right subtree first, the stack keeps each node's level beside it
 template<class ItemType>
-void BinaryTree<ItemType>::_indentedTraversal(int level, void visit(int, ItemType&), BinaryNode<ItemType>* nodePtr) const
+template<class Output>
+void BinaryTree<ItemType>::_indentedTraversal(int level, void visit(int, ItemType&, Output&), BinaryNode<ItemType>* nodePtr, Output& out) const
 {
 	if (nodePtr != 0)
 	{
-		ItemType item = nodePtr->getItem();
-		visit(level, item);
-		_indentedTraversal(level + 1, visit, nodePtr->getRightPtr());
-		_indentedTraversal(level + 1, visit, nodePtr->getLeftPtr());
+		Stack<BinaryNode<ItemType>*> nodes;
+		Stack<int> levels;
+		ItemType item;
+		nodes.push(nodePtr);
+		levels.push(level);
+
+		while (nodes.pop(nodePtr))
+		{
+			levels.pop(level);
+			item = nodePtr->getItem();
+			visit(level, item, out);
+
+			if (nodePtr->getLeftPtr() != 0)
+			{
+				nodes.push(nodePtr->getLeftPtr());
+				levels.push(level + 1);
+			}
+			if (nodePtr->getRightPtr() != 0)
+			{
+				nodes.push(nodePtr->getRightPtr());
+				levels.push(level + 1);
+			}
+		}
 	}
 }
 
@@ -0,0 +1,82 @@
+// Implementation file for the BloomFilter class
+
+#include "BloomFilter.h"
+
+//**************************************************
+// Constructor
+//**************************************************
+BloomFilter::BloomFilter(int expectedItems)
+{
+	counters = 0;
+	numHashes = NUM_HASHES;
+	reset(expectedItems);
+}
+
+//**************************************************
+// Destructor
+//**************************************************
+BloomFilter::~BloomFilter()
+{
+	delete[] counters;
+}
+
+//**************************************************
+// Probe i is h1 + i * h2, with h2 forced odd so the
+// probes of one key do not collapse onto one slot
+//**************************************************
+int BloomFilter::slot(unsigned long long hash, int i) const
+{
+	unsigned long long h1 = hash & 0xFFFFFFFFULL;
+	unsigned long long h2 = (hash >> 32) | 1;
+	return (int)((h1 + i * h2) % numCounters);
+}
+
+//**************************************************
+// Counters saturate at 255 and are then never
+// decremented, so a removal cannot cause a false "absent"
+//**************************************************
+void BloomFilter::add(unsigned long long hash)
+{
+	for (int i = 0; i < numHashes; i++)
+	{
+		unsigned char& counter = counters[slot(hash, i)];
+		if (counter < 255)
+			counter++;
+	}
+}
+
+void BloomFilter::remove(unsigned long long hash)
+{
+	for (int i = 0; i < numHashes; i++)
+	{
+		unsigned char& counter = counters[slot(hash, i)];
+		if (counter > 0 && counter < 255)
+			counter--;
+	}
+}
+
+bool BloomFilter::mayContain(unsigned long long hash) const
+{
+	for (int i = 0; i < numHashes; i++)
+	{
+		if (counters[slot(hash, i)] == 0)
+			return false;
+	}
+	return true;
+}
+
+void BloomFilter::clear()
+{
+	for (int i = 0; i < numCounters; i++)
+		counters[i] = 0;
+}
+
+void BloomFilter::reset(int expectedItems)
+{
+	delete[] counters;
+	if (expectedItems < 1)
+		expectedItems = 1;
+	numCounters = expectedItems * COUNTERS_PER_ITEM;
+	counters = new unsigned char[numCounters];
+	clear();
+}
@@ -0,0 +1,39 @@
+// Specification file for the BloomFilter class
+// Counting Bloom filter over precomputed 64-bit key hashes: answers "definitely
+// absent" or "maybe present", and supports removal of added keys
+
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+#include <cstddef>
+
+class BloomFilter
+{
+private:
+	unsigned char* counters;    // One small counter per slot
+	int numCounters;
+	int numHashes;
+
+	// slot for the i-th probe of a hash, using double hashing
+	int slot(unsigned long long hash, int i) const;
+
+public:
+	// Counters per expected key, about 1% false positives with 4 probes
+	static const int COUNTERS_PER_ITEM = 10;
+	static const int NUM_HASHES = 4;
+
+	BloomFilter(int expectedItems);
+	~BloomFilter();
+
+	void add(unsigned long long hash);
+	void remove(unsigned long long hash);
+	// false means the key was never added (or has been removed)
+	bool mayContain(unsigned long long hash) const;
+	void clear();
+	// resize for a new expected item count, the filter is left empty
+	void reset(int expectedItems);
+
+	int getCounterCount() const { return numCounters; }
+	// heap bytes held by the counters
+	size_t memoryUsage() const { return (size_t)numCounters * sizeof(unsigned char); }
+};
+#endif
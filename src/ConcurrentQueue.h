@@ -0,0 +1,229 @@
+/**~*~*
+   Concurrent queue template
+   Bounded lock-free multi-producer / multi-consumer queue (D. Vyukov's
+   array queue). Each slot carries a sequence number telling producers and
+   consumers whose turn it is, so a push or pop is one CAS on a position
+   counter plus one release store, with no lock.
+*~**/
+#ifndef CONCURRENT_QUEUE_H
+#define CONCURRENT_QUEUE_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+template <class T>
+class ConcurrentQueue
+{
+private:
+   // Structure for the queue slots
+   struct Cell
+   {
+      std::atomic<size_t> sequence;   // pos when free for the producer of pos, pos + 1 when filled
+      T value;
+   };
+
+   Cell *buffer;
+   size_t mask;         // capacity - 1, the capacity is a power of two
+
+   // the counters sit on their own cache lines so producers and consumers do not share one
+   alignas(64) std::atomic<size_t> enqueuePos;
+   alignas(64) std::atomic<size_t> dequeuePos;
+   alignas(64) std::atomic<bool> closed;
+
+   // claim the next free slot, nullptr if the queue is full
+   Cell *claimEnqueue(size_t &pos);
+   // claim the next filled slot, nullptr if the queue is empty
+   Cell *claimDequeue(size_t &pos);
+   // wait a little longer each time a blocking call finds no room or no value
+   static void backoff(int &attempt);
+
+public:
+   // the capacity is rounded up to a power of two
+   explicit ConcurrentQueue(int capacity);
+   ~ConcurrentQueue() { delete[] buffer; }
+   ConcurrentQueue(const ConcurrentQueue<T> &) = delete;
+   ConcurrentQueue<T> &operator=(const ConcurrentQueue<T> &) = delete;
+
+   // non-blocking operations, false if the queue is full (or empty)
+   bool tryEnqueue(const T &);
+   bool tryEnqueue(T &&);
+   bool tryDequeue(T &);
+
+   // blocking operations: enqueue waits for room and fails once the queue
+   // is closed, dequeue waits for a value and fails once closed and drained
+   bool enqueue(const T &);
+   bool enqueue(T &&);
+   bool dequeue(T &);
+
+   // no more values will be enqueued, wakes the blocked callers
+   void close() { closed.store(true, std::memory_order_release); }
+   bool isClosed() const { return closed.load(std::memory_order_acquire); }
+
+   // snapshots, they may be stale by the time they are read
+   bool isEmpty() const { return getCount() == 0; }
+   int getCount() const;
+   int getCapacity() const { return (int)(mask + 1); }
+};
+
+/**~*~*
+   Constructor
+*~**/
+template <class T>
+ConcurrentQueue<T>::ConcurrentQueue(int capacity)
+{
+   size_t size = 2;
+   while ((int)size < capacity)
+      size *= 2;
+   buffer = new Cell[size];
+   mask = size - 1;
+   for (size_t i = 0; i < size; i++)
+      buffer[i].sequence.store(i, std::memory_order_relaxed);
+   enqueuePos.store(0, std::memory_order_relaxed);
+   dequeuePos.store(0, std::memory_order_relaxed);
+   closed.store(false, std::memory_order_relaxed);
+}
+
+/**~*~*
+  Member function claimEnqueue reserves the slot at the
+  enqueue position once the consumer of its last lap is done.
+*~**/
+template <class T>
+typename ConcurrentQueue<T>::Cell *ConcurrentQueue<T>::claimEnqueue(size_t &pos)
+{
+   pos = enqueuePos.load(std::memory_order_relaxed);
+   while (true)
+   {
+      Cell *cell = &buffer[pos & mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+      if (dif == 0)
+      {
+         if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            return cell;
+      }
+      else if (dif < 0)
+         return nullptr;
+      else
+         pos = enqueuePos.load(std::memory_order_relaxed);
+   }
+}
+
+/**~*~*
+  Member function claimDequeue reserves the slot at the
+  dequeue position once its producer is done.
+*~**/
+template <class T>
+typename ConcurrentQueue<T>::Cell *ConcurrentQueue<T>::claimDequeue(size_t &pos)
+{
+   pos = dequeuePos.load(std::memory_order_relaxed);
+   while (true)
+   {
+      Cell *cell = &buffer[pos & mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+      if (dif == 0)
+      {
+         if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            return cell;
+      }
+      else if (dif < 0)
+         return nullptr;
+      else
+         pos = dequeuePos.load(std::memory_order_relaxed);
+   }
+}
+
+template <class T>
+bool ConcurrentQueue<T>::tryEnqueue(const T &item)
+{
+   size_t pos;
+   Cell *cell = claimEnqueue(pos);
+   if (!cell)
+      return false;
+   cell->value = item;
+   cell->sequence.store(pos + 1, std::memory_order_release);
+   return true;
+}
+
+template <class T>
+bool ConcurrentQueue<T>::tryEnqueue(T &&item)
+{
+   size_t pos;
+   Cell *cell = claimEnqueue(pos);
+   if (!cell)
+      return false;
+   cell->value = std::move(item);
+   cell->sequence.store(pos + 1, std::memory_order_release);
+   return true;
+}
+
+template <class T>
+bool ConcurrentQueue<T>::tryDequeue(T &item)
+{
+   size_t pos;
+   Cell *cell = claimDequeue(pos);
+   if (!cell)
+      return false;
+   item = std::move(cell->value);
+   // free the slot for the producer one lap ahead
+   cell->sequence.store(pos + mask + 1, std::memory_order_release);
+   return true;
+}
+
+template <class T>
+bool ConcurrentQueue<T>::enqueue(const T &item)
+{
+   for (int attempt = 0; !isClosed(); backoff(attempt))
+      if (tryEnqueue(item))
+         return true;
+   return false;
+}
+
+template <class T>
+bool ConcurrentQueue<T>::enqueue(T &&item)
+{
+   // item is only moved from once a slot is claimed
+   for (int attempt = 0; !isClosed(); backoff(attempt))
+      if (tryEnqueue(std::move(item)))
+         return true;
+   return false;
+}
+
+template <class T>
+bool ConcurrentQueue<T>::dequeue(T &item)
+{
+   for (int attempt = 0; ; backoff(attempt))
+   {
+      if (tryDequeue(item))
+         return true;
+      // a value enqueued just before close is still handed out
+      if (isClosed())
+         return tryDequeue(item);
+   }
+}
+
+/**~*~*
+  Member function getCount returns the number of
+  values in the queue at some recent moment.
+*~**/
+template <class T>
+int ConcurrentQueue<T>::getCount() const
+{
+   size_t dequeued = dequeuePos.load(std::memory_order_acquire);
+   size_t enqueued = enqueuePos.load(std::memory_order_acquire);
+   return enqueued > dequeued ? (int)(enqueued - dequeued) : 0;
+}
+
+/**~*~*
+  Member function backoff spins briefly, then yields the thread.
+*~**/
+template <class T>
+void ConcurrentQueue<T>::backoff(int &attempt)
+{
+   if (++attempt > 16)
+      std::this_thread::yield();
+}
+
+#endif
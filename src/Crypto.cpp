@@ -6,6 +6,7 @@
 #include <iostream>
 #include "Crypto.h"
 #include <iomanip>
+#include <utility>
 using namespace std;
 
 //**************************************************
@@ -19,6 +20,7 @@ Cryptocurrency::Cryptocurrency()
 	dateFound = 0;
 	price = 0;
 	founder = "";
+	history = nullptr;
 }
 
 //**************************************************
@@ -91,12 +93,82 @@ bool Cryptocurrency::operator == (const Cryptocurrency& obj)
 //**************************************************
 Cryptocurrency::Cryptocurrency(string n, string a, long long s, int d, double p, string f)
 {
-	coinName = n;
-	alg = a;
+	coinName = std::move(n);
+	alg = std::move(a);
 	supply = s;
 	dateFound = d;
 	price = p;
-	founder = f;
+	founder = std::move(f);
+	history = nullptr;
+}
+
+//**************************************************
+// Copy Constructor
+//**************************************************
+Cryptocurrency::Cryptocurrency(const Cryptocurrency& other)
+{
+	coinName = other.coinName;
+	alg = other.alg;
+	supply = other.supply;
+	dateFound = other.dateFound;
+	price = other.price;
+	founder = other.founder;
+	history = other.history ? new PriceHistory(*other.history) : nullptr;
+}
+
+//**************************************************
+// Assignment Operator
+//**************************************************
+Cryptocurrency& Cryptocurrency::operator=(const Cryptocurrency& other)
+{
+	if (this != &other)
+	{
+		coinName = other.coinName;
+		alg = other.alg;
+		supply = other.supply;
+		dateFound = other.dateFound;
+		price = other.price;
+		founder = other.founder;
+		PriceHistory* copy = other.history ? new PriceHistory(*other.history) : nullptr;
+		delete history;
+		history = copy;
+	}
+	return *this;
+}
+
+//**************************************************
+// Move Constructor
+//**************************************************
+Cryptocurrency::Cryptocurrency(Cryptocurrency&& other) noexcept
+{
+	coinName = std::move(other.coinName);
+	alg = std::move(other.alg);
+	supply = other.supply;
+	dateFound = other.dateFound;
+	price = other.price;
+	founder = std::move(other.founder);
+	history = other.history;
+	other.history = nullptr;
+}
+
+//**************************************************
+// Move Assignment Operator
+//**************************************************
+Cryptocurrency& Cryptocurrency::operator=(Cryptocurrency&& other) noexcept
+{
+	if (this != &other)
+	{
+		coinName = std::move(other.coinName);
+		alg = std::move(other.alg);
+		supply = other.supply;
+		dateFound = other.dateFound;
+		price = other.price;
+		founder = std::move(other.founder);
+		delete history;
+		history = other.history;
+		other.history = nullptr;
+	}
+	return *this;
 }
 
 //**************************************************
@@ -104,7 +176,21 @@ Cryptocurrency::Cryptocurrency(string n, string a, long long s, int d, double p,
 //**************************************************
 Cryptocurrency::~Cryptocurrency()
 {
+	delete history;
+}
 
+//**************************************************
+// recordPrice
+//**************************************************
+bool Cryptocurrency::recordPrice(long long timestamp, double p)
+{
+	if (!history)
+		history = new PriceHistory;
+	// a late tick goes to neither the history nor the current price
+	if (!history->append(timestamp, p))
+		return false;
+	price = p;
+	return true;
 }
 
 //***********************************************************
@@ -120,3 +206,21 @@ void Cryptocurrency::display()
 	cout << right << setw(14) << "Founder: " << founder << endl;
 }
 
+//***********************************************************
+// 64-bit FNV-1a hash of a key
+//***********************************************************
+unsigned long long hashKey(const string& key)
+{
+	return hashKey(key.data(), key.size());
+}
+
+unsigned long long hashKey(const char* key, size_t length)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)key[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
@@ -8,6 +8,9 @@
 #define CRYPTOCURRENCY_H
 #include <string> 
 #include <iostream>
+#include <type_traits>
+#include "FixedKey.h"
+#include "PriceHistory.h"
 
 using std::string;
 class Cryptocurrency;
@@ -24,10 +27,18 @@ private:
 	int dateFound;
 	double price;
 	string founder;
+	// Past prices, nullptr until the first one is recorded
+	PriceHistory* history;
 
 public:
 	Cryptocurrency();
 	Cryptocurrency(string n, string a, long long s, int d, double p, string f);
+	// The history is copied with the coin
+	Cryptocurrency(const Cryptocurrency& other);
+	Cryptocurrency& operator=(const Cryptocurrency& other);
+	// and handed over when it is moved, leaving the source without one
+	Cryptocurrency(Cryptocurrency&& other) noexcept;
+	Cryptocurrency& operator=(Cryptocurrency&& other) noexcept;
 	~Cryptocurrency();
 
 	// Setters
@@ -37,14 +48,19 @@ public:
 	void setDate(int d) { dateFound = d; }
 	void setPrice(double p) { price = p; }
 	void setFounder(string f) { founder = f; }
+	// Set the price and add it to the history; false, with the price left
+	// as it was, if timestamp is older than the last recorded price
+	bool recordPrice(long long timestamp, double p);
 
 	// Getters
-	string getName() const { return coinName; }
-	string getAlg() const { return alg; }
+	const string& getName() const { return coinName; }
+	const string& getAlg() const { return alg; }
 	long long getSupply() const { return supply; }
 	int getDate() const { return dateFound; }
 	double getPrice() const { return price; }
-	string getFounder() const { return founder; }
+	const string& getFounder() const { return founder; }
+	// nullptr if no price was recorded
+	const PriceHistory* getHistory() const { return history; }
 
 	// Overloaded
 	bool operator < (const Cryptocurrency& obj);
@@ -58,19 +74,30 @@ public:
 	void display();
 };
 
+// 64-bit hash of a key (FNV-1a)
+unsigned long long hashKey(const string& key);
+// Same hash of length characters, for keys not held in a string
+unsigned long long hashKey(const char* key, size_t length);
+
+// Keys are stored inline (FixedKey) so copying a CryptocurrencyPtr,
+// and the tree and list nodes holding one, never allocates
 struct CryptocurrencyPtr{
 	Cryptocurrency* crypto;
-	string key;
-	string pk;
-
-	CryptocurrencyPtr() { crypto = nullptr; key = ""; pk = ""; };
-	CryptocurrencyPtr(Cryptocurrency* crypto_, string key_) { crypto = crypto_; key = key_; pk = ""; };
-	CryptocurrencyPtr(Cryptocurrency* crypto_, string key_, string pk_) { crypto = crypto_; key = key_; pk = pk_; };
-
-	string getKey() { return key; };
-	string getPK() { return pk; };
-	Cryptocurrency* getCrypto() { return crypto; };
-	void setKey(string k) { key = k; };
+	FixedKey key;
+	FixedKey pk;
+	unsigned long long hash;	// hashKey of the full key string, computed once when the key is set
+
+	CryptocurrencyPtr() { crypto = nullptr; hash = hashKey(""); };
+	CryptocurrencyPtr(Cryptocurrency* crypto_, const string& key_) { crypto = crypto_; setKey(key_); };
+	CryptocurrencyPtr(Cryptocurrency* crypto_, const string& key_, const string& pk_) { crypto = crypto_; setKey(key_); pk = FixedKey(pk_); };
+
+	const FixedKey& getKey() const { return key; };
+	const FixedKey& getPK() const { return pk; };
+	unsigned long long getHash() const { return hash; };
+	Cryptocurrency* getCrypto() const { return crypto; };
+	// the hash covers the whole string, so a key too long for FixedKey
+	// never compares equal to a stored key that shares its first characters
+	void setKey(const string& k) { key = FixedKey(k); hash = hashKey(k); };
 
 	bool operator < (const CryptocurrencyPtr& second) const
 	{
@@ -82,15 +109,18 @@ struct CryptocurrencyPtr{
 		return (this->key > second.key);
 	}
 
+	// Different hashes mean different keys
 	bool operator == (const CryptocurrencyPtr& second) const
 	{
-		return (this->key == second.key);
+		return (this->hash == second.hash && this->key == second.key);
 	}
 
 	bool operator != (const CryptocurrencyPtr& second) const
 	{
-		return (this->key != second.key);
+		return !(*this == second);
 	}
 
 };
+
+static_assert(std::is_trivially_copyable<CryptocurrencyPtr>::value, "CryptocurrencyPtr must stay trivially copyable");
 #endif
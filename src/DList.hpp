@@ -6,13 +6,28 @@
 #ifndef D_LIST_H
 #define D_LIST_H
 #include "ListNode.hpp"
+#include "Prefetch.h"
 
 // DList Template Definition
 template<class T>
 class DList{
+public:
+    // SORTED keeps the list in key order (the default),
+    // UNSORTED appends new nodes at the end in O(1),
+    // MOVE_TO_FRONT inserts at the front and moves every found node there
+    enum ListMode { SORTED, UNSORTED, MOVE_TO_FRONT };
+
 private:
     ListNode<T> *head;
     int count;
+    ListMode mode;
+
+    // find the node with the fingerprint and data in an unsorted list
+    ListNode<T>* findUnsorted(const T &, unsigned long long) const;
+    // unlink a node from the list without deleting it
+    void unlinkNode(ListNode<T> *);
+    // link a node right after pPre
+    void linkAfter(ListNode<T> *, ListNode<T> *);
     
 public:
     DList();   // Constructor
@@ -20,11 +35,33 @@ public:
     
     // Linked list operations
     int getCount() const {return count;}
-    void insertNode(T&);
-    bool deleteNode(T);
-	void traverseForward(void printData(T &)) const;
+    // heap bytes held by the nodes, including the sentinel
+    size_t memoryUsage() const {return (count + 1) * sizeof(ListNode<T>);}
+    ListMode getMode() const {return mode;}
+    // the mode can only be changed while the list is empty
+    bool setMode(ListMode);
+    // the fingerprint is a hash of the key; the unsorted modes compare it
+    // before the data, so it must be the same for equal keys
+    void insertNode(const T&, unsigned long long fingerprint = 0);
+    void insertNode(T&&, unsigned long long fingerprint = 0);
+    // build the data inside a new node from its constructor arguments
+    template<class... Args>
+    void emplaceNode(unsigned long long fingerprint, Args&&... args);
+    // link a node built by the caller, with its fingerprint set, in the
+    // place the mode calls for; the list owns it then
+    void linkNode(ListNode<T> *);
+    bool deleteNode(const T&, unsigned long long fingerprint = 0);
+	// hands each value to printData with an output of any type
+	template<class Output>
+	void traverseForward(void printData(T &, Output &), Output &) const;
 	void traverseBackward(void printData(T &)) const;
-    bool searchList(T, T &) const;
+    // searchList never changes the list, so readers may share it
+    bool searchList(const T&, T &, unsigned long long fingerprint = 0) const;
+    // same, and in MOVE_TO_FRONT mode moves the found node to the front
+    bool searchAndMove(const T&, T &, unsigned long long fingerprint = 0);
+    // cache hints for batched searches: the sentinel, then (once it is loaded) the first node
+    void prefetchHead() const {PREFETCH_READ(head);}
+    void prefetchFront() const {PREFETCH_READ(head->getForw());}
 	bool getNodeAtIndex(int, T&);
 	bool isEmpty();
 };
@@ -42,6 +79,20 @@ DList<T>::DList()
 	head->setForw(head);
 	head->setBack(head);
     count = 0;
+    mode = SORTED;
+}
+
+//**************************************************
+// setMode changes how the list keeps its nodes;
+// returns false if the list is not empty
+//**************************************************
+template<class T>
+bool DList<T>::setMode(ListMode newMode)
+{
+    if (count != 0)
+        return false;
+    mode = newMode;
+    return true;
 }
 
 //**************************************************
@@ -50,15 +101,14 @@ DList<T>::DList()
 // pointed to by head.
 //**************************************************
 template<class T>
-void DList<T>::traverseForward(void printData(T &)) const
+template<class Output>
+void DList<T>::traverseForward(void printData(T &, Output &), Output &out) const
 {
     ListNode<T> *pCur;
-	T data;
     pCur = head->getForw();
     while(pCur != head)
     {
-		data = pCur->getData();
-		printData(data);
+		printData(pCur->getData(), out);
         pCur = pCur->getForw();
     }
     //std::cout << "====================================================" << std::endl;
@@ -73,11 +123,9 @@ template<class T>
 void DList<T>::traverseBackward(void printCity(T &)) const
 {
     ListNode<T> *pCur;
-	T data;
     pCur = head->getBack();
     while(pCur != head)
     {
-		data = pCur->getData();
 		printCity(pCur->getData());
         pCur = pCur->getBack();
     }
@@ -89,10 +137,21 @@ void DList<T>::traverseBackward(void printCity(T &)) const
 // and copied the data in that node to the output parameter
 //**************************************************
 template<class T>
-bool DList<T>::searchList(T targetData, T &dataOut) const
+bool DList<T>::searchList(const T &targetData, T &dataOut, unsigned long long fingerprint) const
 {
     bool found = false;
-    ListNode<T> *pCur = head->getForw();
+    ListNode<T> *pCur;
+
+    if (mode != SORTED)
+    {
+        pCur = findUnsorted(targetData, fingerprint);
+        if (pCur == head)
+            return false;
+        dataOut = pCur->getData();
+        return true;
+    }
+
+    pCur = head->getForw();
 
     while(pCur != head && pCur->getData() < targetData)
         pCur = pCur->getForw();
@@ -106,23 +165,78 @@ bool DList<T>::searchList(T targetData, T &dataOut) const
     return found;
 }
 
+//**************************************************
+// searchAndMove keeps hot keys near the front of a
+// MOVE_TO_FRONT list; the set of nodes does not change
+//**************************************************
+template<class T>
+bool DList<T>::searchAndMove(const T &targetData, T &dataOut, unsigned long long fingerprint)
+{
+    ListNode<T> *pCur;
+
+    if (mode != MOVE_TO_FRONT)
+        return searchList(targetData, dataOut, fingerprint);
+    pCur = findUnsorted(targetData, fingerprint);
+    if (pCur == head)
+        return false;
+    dataOut = pCur->getData();
+    if (pCur != head->getForw())
+    {
+        unlinkNode(pCur);
+        linkAfter(head, pCur);
+    }
+    return true;
+}
+
 //**************************************************
 // The insertNode function inserts a new node in a
 // sorted linked list
 //**************************************************
 template<class T>
-void DList<T>::insertNode(T &dataIn)
+void DList<T>::insertNode(const T &dataIn, unsigned long long fingerprint)
+{
+    ListNode<T> *newNode = new ListNode<T>(dataIn);
+	newNode->setFingerprint(fingerprint);
+    linkNode(newNode);
+}
+
+template<class T>
+void DList<T>::insertNode(T &&dataIn, unsigned long long fingerprint)
+{
+    ListNode<T> *newNode = new ListNode<T>(std::move(dataIn));
+	newNode->setFingerprint(fingerprint);
+    linkNode(newNode);
+}
+
+template<class T>
+template<class... Args>
+void DList<T>::emplaceNode(unsigned long long fingerprint, Args&&... args)
+{
+    ListNode<T> *newNode = new ListNode<T>(std::in_place, std::forward<Args>(args)...);
+	newNode->setFingerprint(fingerprint);
+    linkNode(newNode);
+}
+
+//**************************************************
+// linkNode puts a new node at the front or back of
+// an unsorted list, or in order in a sorted one
+//**************************************************
+template<class T>
+void DList<T>::linkNode(ListNode<T> *newNode)
 {
-    ListNode<T> *newNode;
     ListNode<T> *pPre;
     ListNode<T> *pCur;
-    
-    newNode = new ListNode<T>();
-	newNode->setData(dataIn);
+
+    if (mode != SORTED)
+    {
+        linkAfter(mode == MOVE_TO_FRONT ? head : head->getBack(), newNode);
+        count++;
+        return;
+    }
     
     pPre = head;
 	pCur = head->getForw();
-    while(pCur != head && pCur->getData() < dataIn)
+    while(pCur != head && pCur->getData() < newNode->getData())
     {
         pPre = pCur;
 		pCur = pCur->getForw();
@@ -142,12 +256,23 @@ void DList<T>::insertNode(T &dataIn)
 // deleted from the list and from memory.
 //**************************************************
 template<class T>
-bool DList<T>::deleteNode(T target)
+bool DList<T>::deleteNode(const T &target, unsigned long long fingerprint)
 {
     ListNode<T> *pCur;
     ListNode<T> *pPre;
     bool deleted = false;
 
+    if (mode != SORTED)
+    {
+        pCur = findUnsorted(target, fingerprint);
+        if (pCur == head)
+            return false;
+        unlinkNode(pCur);
+        delete pCur;
+        count--;
+        return true;
+    }
+
     pPre = head;
     pCur = head->getForw();
     while(pCur != head && pCur->getData() < target)
@@ -189,6 +314,35 @@ bool DList<T>::getNodeAtIndex(int index, T& dataOut)
     return found;
 }
 
+//**************************************************
+// findUnsorted walks the whole list, comparing the
+// fingerprints first; returns head if not found
+//**************************************************
+template<class T>
+ListNode<T>* DList<T>::findUnsorted(const T &target, unsigned long long fingerprint) const
+{
+    ListNode<T> *pCur = head->getForw();
+    while (pCur != head && !(pCur->getFingerprint() == fingerprint && pCur->getData() == target))
+        pCur = pCur->getForw();
+    return pCur;
+}
+
+template<class T>
+void DList<T>::unlinkNode(ListNode<T> *pCur)
+{
+    pCur->getBack()->setForw(pCur->getForw());
+    pCur->getForw()->setBack(pCur->getBack());
+}
+
+template<class T>
+void DList<T>::linkAfter(ListNode<T> *pPre, ListNode<T> *newNode)
+{
+    newNode->setBack(pPre);
+    newNode->setForw(pPre->getForw());
+    pPre->getForw()->setBack(newNode);
+    pPre->setForw(newNode);
+}
+
 //**************************************************
 // isEmpty
 // check if the list is empty
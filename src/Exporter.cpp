@@ -0,0 +1,290 @@
+// Implementation file for the Exporter classes
+
+#include "Exporter.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// Column names, in the order every format writes them
+	const char* const COLUMN_NAMES[] = { "name", "algorithm", "supply", "founder", "year", "price" };
+	const int COLUMNS = 6;
+
+	// Columnar types
+	const unsigned char STRING_COLUMN = 1;
+	const unsigned char INT64_COLUMN = 2;
+	const unsigned char INT32_COLUMN = 3;
+	const unsigned char FLOAT64_COLUMN = 4;
+	const unsigned char COLUMN_TYPES[] = { STRING_COLUMN, STRING_COLUMN, INT64_COLUMN, STRING_COLUMN, INT32_COLUMN, FLOAT64_COLUMN };
+
+	const char HEX_DIGITS[] = "0123456789abcdef";
+}
+
+//**************************************************
+// create
+//**************************************************
+Exporter* Exporter::create(Format format, RowWriter& out)
+{
+	switch (format)
+	{
+	case CSV:
+		return new CsvExporter(out);
+	case NDJSON:
+		return new JsonExporter(out);
+	case COLUMNAR:
+		return new ColumnarExporter(out);
+	case TEXT:
+		return new TextExporter(out);
+	}
+	return nullptr;
+}
+
+//**************************************************
+// extension
+//**************************************************
+const char* Exporter::extension(Format format)
+{
+	switch (format)
+	{
+	case CSV:
+		return "csv";
+	case NDJSON:
+		return "ndjson";
+	case COLUMNAR:
+		return "col";
+	case TEXT:
+		return "txt";
+	}
+	return "";
+}
+
+//**************************************************
+// CSV
+//**************************************************
+void CsvExporter::begin()
+{
+	for (int i = 0; i < COLUMNS; i++)
+	{
+		if (i > 0)
+			out.put(',');
+		out.put(COLUMN_NAMES[i]);
+	}
+	out.newline();
+}
+
+void CsvExporter::write(const Cryptocurrency& crypto)
+{
+	putField(crypto.getName());
+	out.put(',');
+	putField(crypto.getAlg());
+	out.put(',').put(crypto.getSupply()).put(',');
+	putField(crypto.getFounder());
+	out.put(',').put(crypto.getDate()).put(',').putExact(crypto.getPrice()).newline();
+	count++;
+}
+
+//**************************************************
+// putField quotes a field holding a comma, a quote
+// or a line break and doubles its quotes
+//**************************************************
+void CsvExporter::putField(const string& text)
+{
+	if (text.find_first_of(",\"\r\n") == string::npos)
+	{
+		out.put(text);
+		return;
+	}
+	out.put('"');
+	size_t start = 0, quote;
+	while ((quote = text.find('"', start)) != string::npos)
+	{
+		out.put(text.data() + start, quote + 1 - start).put('"');
+		start = quote + 1;
+	}
+	out.put(text.data() + start, text.size() - start).put('"');
+}
+
+//**************************************************
+// NDJSON
+//**************************************************
+void JsonExporter::write(const Cryptocurrency& crypto)
+{
+	out.put("{\"name\":");
+	putString(crypto.getName());
+	out.put(",\"algorithm\":");
+	putString(crypto.getAlg());
+	out.put(",\"supply\":").put(crypto.getSupply()).put(",\"founder\":");
+	putString(crypto.getFounder());
+	out.put(",\"year\":").put(crypto.getDate()).put(",\"price\":");
+	// JSON has no NaN or infinity
+	if (std::isfinite(crypto.getPrice()))
+		out.putExact(crypto.getPrice());
+	else
+		out.put("null");
+	out.put('}').newline();
+	count++;
+}
+
+//**************************************************
+// putString writes a quoted JSON string, runs of
+// characters that need no escape are copied at once
+//**************************************************
+void JsonExporter::putString(const string& text)
+{
+	const char* p = text.data();
+	const char* last = p + text.size();
+	const char* run = p;
+	out.put('"');
+	for (; p < last; p++)
+	{
+		unsigned char c = (unsigned char)*p;
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+		out.put(run, p - run);
+		run = p + 1;
+		switch (c)
+		{
+		case '"': out.put("\\\""); break;
+		case '\\': out.put("\\\\"); break;
+		case '\n': out.put("\\n"); break;
+		case '\r': out.put("\\r"); break;
+		case '\t': out.put("\\t"); break;
+		default:
+			out.put("\\u00").put(HEX_DIGITS[c >> 4]).put(HEX_DIGITS[c & 15]);
+		}
+	}
+	out.put(run, p - run).put('"');
+}
+
+//**************************************************
+// Text
+//**************************************************
+void TextExporter::begin()
+{
+	out.put("Cryptocurrency Database\n\n");
+	out.put("============= ============= ============ ======= ======== =====================\n");
+	out.put("Algorithm     Supply        Founder      Year    Price    Coin Name\n");
+	out.put("============= ============= ============ ======= ======== =====================\n");
+}
+
+void TextExporter::write(const Cryptocurrency& crypto)
+{
+	out.left(crypto.getAlg(), 13).put(' ').left(crypto.getSupply(), 13).put(' ').left(crypto.getFounder(), 12)
+		.put(' ').left(crypto.getDate(), 7).put(' ').left(crypto.getPrice(), 8).put(' ').left(crypto.getName(), 22).newline();
+	count++;
+}
+
+//**************************************************
+// Columnar constructor
+//**************************************************
+ColumnarExporter::ColumnarExporter(RowWriter& writer)
+	: Exporter(writer)
+{
+	groupRows = 0;
+	supplies.reserve(GROUP_ROWS * 8);
+	dates.reserve(GROUP_ROWS * 4);
+	prices.reserve(GROUP_ROWS * 8);
+}
+
+//**************************************************
+// begin writes the magic, version and column list
+//**************************************************
+void ColumnarExporter::begin()
+{
+	vector<char> header;
+	header.insert(header.end(), "CRYPTCOL", "CRYPTCOL" + 8);
+	appendLittleEndian(header, VERSION, 4);
+	appendLittleEndian(header, COLUMNS, 4);
+	for (int i = 0; i < COLUMNS; i++)
+	{
+		size_t length = strlen(COLUMN_NAMES[i]);
+		header.push_back((char)COLUMN_TYPES[i]);
+		header.push_back((char)length);
+		header.insert(header.end(), COLUMN_NAMES[i], COLUMN_NAMES[i] + length);
+	}
+	putColumn(out, header);
+}
+
+void ColumnarExporter::write(const Cryptocurrency& crypto)
+{
+	unsigned long long priceBits;
+	double price = crypto.getPrice();
+	memcpy(&priceBits, &price, sizeof(priceBits));
+
+	addString(names, crypto.getName());
+	addString(algs, crypto.getAlg());
+	addString(founders, crypto.getFounder());
+	appendLittleEndian(supplies, (unsigned long long)crypto.getSupply(), 8);
+	appendLittleEndian(dates, (unsigned long long)(unsigned)crypto.getDate(), 4);
+	appendLittleEndian(prices, priceBits, 8);
+	count++;
+	if (++groupRows == GROUP_ROWS)
+		writeGroup();
+}
+
+//**************************************************
+// end writes the last partial group and the empty
+// group that ends the file
+//**************************************************
+void ColumnarExporter::end()
+{
+	if (groupRows > 0)
+		writeGroup();
+	vector<char> last;
+	appendLittleEndian(last, 0, 4);
+	putColumn(out, last);
+}
+
+//**************************************************
+// writeGroup writes the columns of the open group
+// in column order and empties them
+//**************************************************
+void ColumnarExporter::writeGroup()
+{
+	vector<char> rows;
+	appendLittleEndian(rows, (unsigned long long)groupRows, 4);
+	putColumn(out, rows);
+
+	StringColumn* strings[] = { &names, &algs, nullptr, &founders, nullptr, nullptr };
+	vector<char>* numbers[] = { nullptr, nullptr, &supplies, nullptr, &dates, &prices };
+	for (int i = 0; i < COLUMNS; i++)
+	{
+		if (strings[i])
+		{
+			putColumn(out, strings[i]->lengths);
+			putColumn(out, strings[i]->bytes);
+			strings[i]->lengths.clear();
+			strings[i]->bytes.clear();
+		}
+		else
+		{
+			putColumn(out, *numbers[i]);
+			numbers[i]->clear();
+		}
+	}
+	groupRows = 0;
+}
+
+void ColumnarExporter::addString(StringColumn& column, const string& text)
+{
+	appendLittleEndian(column.lengths, text.size(), 4);
+	column.bytes.insert(column.bytes.end(), text.begin(), text.end());
+}
+
+void ColumnarExporter::putColumn(RowWriter& out, const vector<char>& column)
+{
+	out.put(column.data(), column.size());
+}
+
+//**************************************************
+// appendLittleEndian adds the low bytes of value,
+// lowest first, whatever the order of this machine
+//**************************************************
+void ColumnarExporter::appendLittleEndian(vector<char>& column, unsigned long long value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+	{
+		column.push_back((char)(value & 0xff));
+		value >>= 8;
+	}
+}
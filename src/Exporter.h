@@ -0,0 +1,112 @@
+// Specification file for the Exporter classes
+// An exporter turns the coins of an in-order traversal into one
+// format, writing each field straight into a RowWriter as it is visited.
+// The machine-readable formats write the same columns in the same
+// order: name, algorithm, supply, founder, year, price.
+
+#ifndef EXPORTER_H
+#define EXPORTER_H
+#include "Crypto.h"
+#include "RowWriter.h"
+#include <vector>
+
+using std::vector;
+
+class Exporter
+{
+public:
+	enum Format { CSV, NDJSON, COLUMNAR, TEXT };
+
+	// a new exporter of format writing to out, the caller deletes it
+	static Exporter* create(Format format, RowWriter& out);
+	// file extension of a format, without the dot
+	static const char* extension(Format format);
+
+	virtual ~Exporter() {}
+	Exporter(const Exporter&) = delete;
+	Exporter& operator=(const Exporter&) = delete;
+
+	// called once before the first coin and once after the last one
+	virtual void begin() {}
+	virtual void write(const Cryptocurrency& crypto) = 0;
+	virtual void end() {}
+
+	int getCount() const { return count; }
+
+protected:
+	RowWriter& out;
+	int count;      // coins written
+
+	explicit Exporter(RowWriter& writer) : out(writer) { count = 0; }
+};
+
+// RFC 4180 CSV with a header line, fields are quoted only when they need it
+class CsvExporter : public Exporter
+{
+public:
+	explicit CsvExporter(RowWriter& writer) : Exporter(writer) {}
+	void begin() override;
+	void write(const Cryptocurrency& crypto) override;
+
+private:
+	void putField(const string& text);
+};
+
+// One JSON object per line
+class JsonExporter : public Exporter
+{
+public:
+	explicit JsonExporter(RowWriter& writer) : Exporter(writer) {}
+	void write(const Cryptocurrency& crypto) override;
+
+private:
+	void putString(const string& text);
+};
+
+// The fixed-width listing of SortedOutput.txt
+class TextExporter : public Exporter
+{
+public:
+	explicit TextExporter(RowWriter& writer) : Exporter(writer) {}
+	void begin() override;
+	void write(const Cryptocurrency& crypto) override;
+};
+
+// Columnar binary file, all numbers little-endian:
+//   "CRYPTCOL", uint32 version, uint32 column count,
+//   per column: uint8 type (1 string, 2 int64, 3 int32, 4 float64),
+//               uint8 name length, name
+//   row groups: uint32 row count (0 ends the file), then each column:
+//               strings as row count uint32 lengths followed by their bytes,
+//               numbers as row count values
+// Up to GROUP_ROWS coins are buffered, one column array each.
+class ColumnarExporter : public Exporter
+{
+public:
+	static const int GROUP_ROWS = 4096;
+	static const unsigned VERSION = 1;
+
+	explicit ColumnarExporter(RowWriter& writer);
+	void begin() override;
+	void write(const Cryptocurrency& crypto) override;
+	void end() override;
+
+private:
+	// The column arrays of the open group
+	struct StringColumn
+	{
+		vector<char> lengths;   // uint32 per row
+		vector<char> bytes;
+	};
+	StringColumn names, algs, founders;
+	vector<char> supplies;      // int64 per row
+	vector<char> dates;         // int32 per row
+	vector<char> prices;        // float64 per row
+	int groupRows;
+
+	void writeGroup();
+	static void addString(StringColumn& column, const string& text);
+	static void putColumn(RowWriter& out, const vector<char>& column);
+	static void appendLittleEndian(vector<char>& column, unsigned long long value, int bytes);
+};
+#endif
@@ -0,0 +1,182 @@
+// Read-only sorted index in Eytzinger (breadth-first) layout
+// The implicit tree stores the children of slot k at 2k and 2k + 1, so a
+// search touches one array and the next levels can be prefetched ahead of time
+
+#ifndef _EYTZINGER_INDEX
+#define _EYTZINGER_INDEX
+#include <vector>
+#include "Prefetch.h"
+
+template<class ItemType>
+class EytzingerIndex
+{
+private:
+	std::vector<ItemType> items;	// 1-based, slot 0 is unused
+	int count;
+
+	// first slot of the in-order walk of the implicit tree
+	int first() const;
+	// in-order successor of slot k, 0 past the last one
+	int next(int k) const;
+	// slot of the first item not less than target, 0 if there is none
+	int lowerBound(const ItemType& target) const;
+
+public:
+	EytzingerIndex() { count = 0; }
+
+	int size() const { return count; }
+	bool isEmpty() const { return count == 0; }
+	// replace the contents with items taken in sorted order from visitSorted
+	template<class SortedSource>
+	void build(int n, SortedSource& visitSorted);
+	// find an item equal to target
+	bool find(const ItemType& target, ItemType& returnedItem) const;
+	// find n targets at once, found[i] tells if results[i] was filled in; the
+	// descents of a group run level by level so their cache misses overlap
+	int findMany(const ItemType targets[], int n, ItemType results[], bool found[]) const;
+	// visit every item equal to target in sorted order, returns the number visited
+	int findAll(const ItemType& target, void visit(ItemType&)) const;
+	// heap bytes held by the array
+	size_t memoryUsage() const { return items.capacity() * sizeof(ItemType); }
+};
+
+///////////////////////// public function definitions ///////////////////////////
+
+// SortedSource is called as visitSorted(ItemType&) and fills in the next item in order each call
+template<class ItemType>
+template<class SortedSource>
+void EytzingerIndex<ItemType>::build(int n, SortedSource& visitSorted)
+{
+	count = n;
+	items.assign(n + 1, ItemType());
+	// the in-order walk of the implicit tree meets the slots in sorted position order
+	for (int k = first(); k != 0; k = next(k))
+		visitSorted(items[k]);
+}
+
+template<class ItemType>
+bool EytzingerIndex<ItemType>::find(const ItemType& target, ItemType& returnedItem) const
+{
+	int k = lowerBound(target);
+	if (k != 0 && items[k] == target)
+	{
+		returnedItem = items[k];
+		return true;
+	}
+	return false;
+}
+
+template<class ItemType>
+int EytzingerIndex<ItemType>::findMany(const ItemType targets[], int n, ItemType results[], bool found[]) const
+{
+	const ItemType* base = items.data();
+	int slot[PREFETCH_GROUP];
+	int numFound = 0;
+
+	for (int start = 0; start < n; start += PREFETCH_GROUP)
+	{
+		int groupSize = n - start < PREFETCH_GROUP ? n - start : PREFETCH_GROUP;
+		int active = count > 0 ? groupSize : 0;
+		for (int i = 0; i < groupSize; i++)
+			slot[i] = 1;
+		// every descent is one step further each round; they all end within a level of each other
+		while (active > 0)
+		{
+			active = 0;
+			for (int i = 0; i < groupSize; i++)
+			{
+				int k = slot[i];
+				if (k > count)
+					continue;
+				k = 2 * k + (base[k] < targets[start + i]);
+				if (k <= count)
+				{
+					PREFETCH_READ(base + k);
+					active++;
+				}
+				slot[i] = k;
+			}
+		}
+		for (int i = 0; i < groupSize; i++)
+		{
+			int k = slot[i];
+			while (k & 1)
+				k >>= 1;
+			k >>= 1;
+			found[start + i] = (k != 0 && items[k] == targets[start + i]);
+			if (found[start + i])
+			{
+				results[start + i] = items[k];
+				numFound++;
+			}
+		}
+	}
+	return numFound;
+}
+
+template<class ItemType>
+int EytzingerIndex<ItemType>::findAll(const ItemType& target, void visit(ItemType&)) const
+{
+	int visited = 0;
+	for (int k = lowerBound(target); k != 0 && !(target < items[k]); k = next(k))
+	{
+		if (items[k] == target)
+		{
+			ItemType item = items[k];
+			visit(item);
+			visited++;
+		}
+	}
+	return visited;
+}
+
+//////////////////////////// private functions ////////////////////////////////////////////
+
+template<class ItemType>
+int EytzingerIndex<ItemType>::first() const
+{
+	if (count == 0)
+		return 0;
+	int k = 1;
+	while (2 * k <= count)
+		k = 2 * k;
+	return k;
+}
+
+template<class ItemType>
+int EytzingerIndex<ItemType>::next(int k) const
+{
+	if (2 * k + 1 <= count)
+	{
+		// leftmost slot of the right subtree
+		k = 2 * k + 1;
+		while (2 * k <= count)
+			k = 2 * k;
+		return k;
+	}
+	// climb while k is a right child, then once more to the parent
+	while (k & 1)
+		k >>= 1;
+	return k >> 1;
+}
+
+// The descent has no data-dependent branch: each step picks the child with
+// the comparison result, and the slots two levels down are prefetched
+template<class ItemType>
+int EytzingerIndex<ItemType>::lowerBound(const ItemType& target) const
+{
+	const ItemType* base = items.data();
+	int k = 1;
+	while (k <= count)
+	{
+		if (4 * k <= count)
+			PREFETCH_READ(base + 4 * k);
+		k = 2 * k + (base[k] < target);
+	}
+	// drop the trailing right turns and the final left turn, leaving the last slot not less than target
+	while (k & 1)
+		k >>= 1;
+	return k >> 1;
+}
+
+#endif
@@ -0,0 +1,60 @@
+// Specification file for the FixedKey class
+// A short string stored inline in a fixed 32-byte block:
+// trivially copyable, no heap allocation, compared with memcmp
+
+#ifndef FIXED_KEY_H
+#define FIXED_KEY_H
+#include <string>
+#include <cstring>
+#include <iostream>
+
+using std::string;
+
+class FixedKey
+{
+public:
+	// Longest key that can be stored
+	static const int CAPACITY = 31;
+
+private:
+	char chars[CAPACITY];   // Characters, zero padded
+	unsigned char length;
+
+public:
+	FixedKey() { memset(chars, 0, CAPACITY); length = 0; }
+	// Keys longer than CAPACITY are cut off, check fits() before storing one
+	FixedKey(const string& s)
+	{
+		length = (unsigned char)(s.size() < (size_t)CAPACITY ? s.size() : CAPACITY);
+		memset(chars, 0, CAPACITY);
+		memcpy(chars, s.data(), length);
+	}
+
+	static bool fits(const string& s) { return s.size() <= (size_t)CAPACITY; }
+
+	int size() const { return length; }
+	bool empty() const { return length == 0; }
+	const char* data() const { return chars; }
+	string str() const { return string(chars, length); }
+
+	// The zero padding makes memcmp order keys like strings,
+	// the length only breaks ties for keys ending in zero bytes
+	int compare(const FixedKey& other) const
+	{
+		int result = memcmp(chars, other.chars, CAPACITY);
+		if (result != 0)
+			return result;
+		return (int)length - (int)other.length;
+	}
+
+	bool operator < (const FixedKey& other) const { return compare(other) < 0; }
+	bool operator > (const FixedKey& other) const { return compare(other) > 0; }
+	bool operator == (const FixedKey& other) const { return length == other.length && memcmp(chars, other.chars, CAPACITY) == 0; }
+	bool operator != (const FixedKey& other) const { return !(*this == other); }
+
+	friend std::ostream& operator << (std::ostream& strm, const FixedKey& key)
+	{
+		return strm.write(key.chars, key.length);
+	}
+};
+#endif
@@ -2,6 +2,7 @@
 // Hash table template 
 // Collision resolution method: linked list
 // Rehash when exceed the threshold
+// Items carry their own cached hash (getHash), so keys are hashed once
 // Created by Michael Wong
 // Modified by Meng Leong Un
 
@@ -9,7 +10,9 @@
 #define _HASH_TABLE
 #include <string>
 #include "DList.hpp"
+#include "BloomFilter.h"
 #include <cmath>
+#include <utility>
 
 template<class ItemType>
 class HashTable
@@ -18,46 +21,72 @@ private:
 	int CAPACITY = 0; 
 	// Threshold for re-hashing
 	int THRESHOLD = 75; 
-	int hash(string&) const;
-	int goodHash(string& key) const;
-	int badHash(string& key) const;
-
-	bool _findItem(DList<ItemType>*, string&, ItemType&, ItemType&);
-	bool _deleteItem(DList<ItemType>*, string&, ItemType&);
-	bool _insertItem(DList<ItemType>*, string&, ItemType*);
-	void reHash();
+	// bucket index of an item's cached hash, the hash is also the bucket fingerprint
+	int hash(const ItemType&) const;
+
+	bool _findItem(DList<ItemType>*, ItemType&, ItemType&);
+	bool _deleteItem(DList<ItemType>*, ItemType&);
+	// link a new node into its bucket, false if the table is full
+	bool _insertNode(DList<ItemType>*, ListNode<ItemType>*);
+	// rehash if needed, then insert the node; deletes it if not inserted
+	bool insertNode(ListNode<ItemType>*);
+	// grow to at least twice the capacity, or minCapacity if larger
+	void reHash(int minCapacity = 0);
 	bool isPrime(int);
 	int nextPrime(int);
 	// dynamically allocated array
 	DList<ItemType>* hashTable;
 	int counter = 0;
 	int collision = 0;
+	// ordering of the items inside each bucket
+	typename DList<ItemType>::ListMode bucketMode;
+	// optional filter in front of lookups, nullptr when disabled
+	BloomFilter* filter = nullptr;
 
 public:
-	HashTable(int);
-	~HashTable() { delete[] this->hashTable; };
-	// Take the any string as key and store the pointer to the object
-	bool insertItem(string&, ItemType*);
+	HashTable(int, typename DList<ItemType>::ListMode mode = DList<ItemType>::SORTED);
+	~HashTable() { delete[] this->hashTable; delete filter; };
+	// Keep a Bloom filter of the stored keys so misses skip the bucket walk
+	void enableFilter();
+	// Store a copy of the object, the item carries its own key
+	bool insertItem(ItemType*);
+	// Same, moving the item into its bucket
+	bool insertItem(ItemType&&);
+	// Build the item in place in its node from its constructor arguments
+	template<class... Args>
+	bool emplaceItem(Args&&...);
 	// Find the item with the key
-	bool findItem(string&, ItemType&);
+	bool findItem(const string&, ItemType&);
+	// Find the items for n keys at once, found[i] tells if results[i] was filled in;
+	// the buckets of a group of keys are prefetched before any of them is searched
+	int findMany(const string keys[], int n, ItemType results[], bool found[]);
 	// Delete the item with the corresponding key
-	bool deleteItem(string&);
+	bool deleteItem(const string&);
+	// Grow once so n items fit under the threshold, a batch of
+	// inserts then rehashes at most once instead of at each step
+	void reserve(int n);
 	int getSize() { return counter; };
 	int getCapacity() { return CAPACITY; };
 	int getCollision() { return collision; };
 	int getLoadFactor() { return (int)(((double)counter/(double)CAPACITY)*100.0); };
 	bool isFull() { return counter == CAPACITY; };
 	bool isEmpty() { return counter == 0; }
-	// Print items in the table
-	void printTable(void printHeader(), void printData(ItemType&));
-	// Print all items including gaps in the table
-	void printInfo(void printHeader(), void printData(ItemType&));
+	// heap bytes held by the buckets, their nodes and the filter
+	size_t memoryUsage() const;
+	// Print items in the table to an output of any type,
+	// printBucket writes the line above each bucket holding items
+	template<class Output>
+	void printTable(void printHeader(Output&), void printBucket(int, Output&), void printData(ItemType&, Output&), Output& out);
+	// Print all items including gaps in the table,
+	// printBucket writes the line below every bucket
+	template<class Output>
+	void printInfo(void printHeader(Output&), void printBucket(int, Output&), void printData(ItemType&, Output&), Output& out);
 };
 
 template<class ItemType>
 bool HashTable<ItemType>::isPrime(int num)
 {
-	for (int i = 2; i < num / 2; i++)
+	for (int i = 2; i * i <= num; i++)
 	{
 		if (num % i == 0)
 			return false;
@@ -74,43 +103,43 @@ int HashTable<ItemType>::nextPrime(int num)
 }
 
 template<class ItemType>
-HashTable<ItemType>::HashTable(int size)
+HashTable<ItemType>::HashTable(int size, typename DList<ItemType>::ListMode mode)
 {
 	CAPACITY = nextPrime(size * 2);
 	counter = 0;
+	bucketMode = mode;
 	this->hashTable = new DList<ItemType>[CAPACITY]; 
+	for (int i = 0; i < CAPACITY; i++)
+		this->hashTable[i].setMode(bucketMode);
 }
 
 template<class ItemType>
-int HashTable<ItemType>::hash(string& key) const
+int HashTable<ItemType>::hash(const ItemType& item) const
 {
-	// Change it manually for different hash function
-	return goodHash(key);
+	return (int)(item.getHash() % CAPACITY);
 }
 
 template<class ItemType>
-int HashTable<ItemType>::goodHash(string& key) const
+bool HashTable<ItemType>::insertItem(ItemType* entry)
 {
-	long long index = 0;
-	for (int i = 1; i <= key.size(); i++) {
-		int c = (int)key[i - 1];
-		index += static_cast<int>(pow(c, 3) + pow(c, 2) + i);
-	}
-	return index % CAPACITY;
+	return insertNode(new ListNode<ItemType>(*entry));
 }
 
 template<class ItemType>
-int HashTable<ItemType>::badHash(string& key) const
+bool HashTable<ItemType>::insertItem(ItemType&& entry)
 {
-	long long index = 0;
-	for (int i = 0; i < key.size(); i++) {
-		index += key[i];
-	}
-	return index % CAPACITY;
+	return insertNode(new ListNode<ItemType>(std::move(entry)));
 }
 
 template<class ItemType>
-bool HashTable<ItemType>::insertItem(string& key, ItemType* entry)
+template<class... Args>
+bool HashTable<ItemType>::emplaceItem(Args&&... args)
+{
+	return insertNode(new ListNode<ItemType>(std::in_place, std::forward<Args>(args)...));
+}
+
+template<class ItemType>
+bool HashTable<ItemType>::insertNode(ListNode<ItemType>* newNode)
 {
 	//cout << getLoadFactor() << endl;
 	if (getLoadFactor() >= THRESHOLD)
@@ -118,17 +147,40 @@ bool HashTable<ItemType>::insertItem(string& key, ItemType* entry)
 		reHash();
 	}
 	// return true if insert successful
-	return _insertItem(this->hashTable, key, entry);
+	if (!_insertNode(this->hashTable, newNode))
+	{
+		delete newNode;
+		return false;
+	}
+	if (filter)
+		filter->add(newNode->getData().getHash());
+	return true;
+}
+
+/* enableFilter:
+		build the filter from the keys already in the table
+*/
+template<class ItemType>
+void HashTable<ItemType>::enableFilter()
+{
+	ItemType linkedListItem;
+	if (filter)
+		return;
+	filter = new BloomFilter(CAPACITY);
+	for (int i = 0; i < CAPACITY; i++)
+		for (int j = 0; j < this->hashTable[i].getCount(); j++)
+			if (this->hashTable[i].getNodeAtIndex(j, linkedListItem))
+				filter->add(linkedListItem.getHash());
 }
 
 
-/* findNextIndex:
-		insert new item to the table, return false if fulled
+/* _insertNode:
+		insert new node to the table, return false if fulled
 */
 template<class ItemType>
-bool HashTable<ItemType>::_insertItem(DList<ItemType>* table, string& key, ItemType* entry)
+bool HashTable<ItemType>::_insertNode(DList<ItemType>* table, ListNode<ItemType>* newNode)
 {
-	int index = hash(key);
+	int index = hash(newNode->getData());
 	if (!isFull()) {
 		// If the linked list is empty, which menas no collision
 		if (table[index].isEmpty())
@@ -136,7 +188,8 @@ bool HashTable<ItemType>::_insertItem(DList<ItemType>* table, string& key, ItemT
 		// If the linked list is not empty, which means collision occoured
 		else
 			collision++;
-		table[index].insertNode(*entry);
+		newNode->setFingerprint(newNode->getData().getHash());
+		table[index].linkNode(newNode);
 		return true;
 	}
 	return false;
@@ -147,27 +200,78 @@ bool HashTable<ItemType>::_insertItem(DList<ItemType>* table, string& key, ItemT
 		find the item with given key
 */
 template<class ItemType>
-bool HashTable<ItemType>::findItem(string& key, ItemType& result)
+bool HashTable<ItemType>::findItem(const string& key, ItemType& result)
 {
+	// the dummy object hashes the key once for the filter and the bucket
 	ItemType dummyPtr(nullptr, key);
+	// the filter rules out keys that were never inserted
+	if (filter && !filter->mayContain(dummyPtr.getHash()))
+		return false;
 	// return true if item found
-	return _findItem(this->hashTable, key, dummyPtr, result);
+	return _findItem(this->hashTable, dummyPtr, result);
 
 }
 
+/* findMany:
+		find the items with given keys, returns the number found
+		each group of keys goes through the stages together, so the cache
+		misses of one stage overlap: hash and prefetch the bucket, prefetch
+		its sentinel node, prefetch its first node, then search
+*/
+template<class ItemType>
+int HashTable<ItemType>::findMany(const string keys[], int n, ItemType results[], bool found[])
+{
+	ItemType dummyPtrs[PREFETCH_GROUP];
+	int index[PREFETCH_GROUP];
+	int numFound = 0;
+
+	for (int start = 0; start < n; start += PREFETCH_GROUP)
+	{
+		int groupSize = n - start < PREFETCH_GROUP ? n - start : PREFETCH_GROUP;
+		for (int i = 0; i < groupSize; i++)
+		{
+			dummyPtrs[i] = ItemType(nullptr, keys[start + i]);
+			found[start + i] = false;
+			// the filter rules out keys that were never inserted
+			if (isEmpty() || (filter && !filter->mayContain(dummyPtrs[i].getHash())))
+				index[i] = -1;
+			else
+			{
+				index[i] = hash(dummyPtrs[i]);
+				PREFETCH_READ(&this->hashTable[index[i]]);
+			}
+		}
+		for (int i = 0; i < groupSize; i++)
+			if (index[i] >= 0)
+				this->hashTable[index[i]].prefetchHead();
+		for (int i = 0; i < groupSize; i++)
+			if (index[i] >= 0)
+				this->hashTable[index[i]].prefetchFront();
+		for (int i = 0; i < groupSize; i++)
+		{
+			if (index[i] >= 0 && this->hashTable[index[i]].searchAndMove(dummyPtrs[i], results[start + i], dummyPtrs[i].getHash()))
+			{
+				found[start + i] = true;
+				numFound++;
+			}
+		}
+	}
+	return numFound;
+}
+
 /* _findItem:
 		A private function find the item with given key in a dummy object
 */
 template<class ItemType>
-bool HashTable<ItemType>::_findItem(DList<ItemType>* table, string& key, ItemType& item, ItemType& result) 
+bool HashTable<ItemType>::_findItem(DList<ItemType>* table, ItemType& item, ItemType& result) 
 {
-	int index = hash(key);
+	int index = hash(item);
 	ItemType resultPtr;
 
 	if(!isEmpty())
 	{
 		// if item is found in the linked list
-		if (table[index].searchList(item, resultPtr))
+		if (table[index].searchAndMove(item, resultPtr, item.getHash()))
 		{
 			result = resultPtr;
 			return true;
@@ -180,10 +284,16 @@ bool HashTable<ItemType>::_findItem(DList<ItemType>* table, string& key, ItemTyp
 		find and set the pointer to nullptr
 */
 template<class ItemType>
-bool HashTable<ItemType>::deleteItem(string& key)
+bool HashTable<ItemType>::deleteItem(const string& key)
 {
 	ItemType dummyPtr(nullptr, key);
-	return _deleteItem(this->hashTable, key, dummyPtr);
+	if (filter && !filter->mayContain(dummyPtr.getHash()))
+		return false;
+	if (!_deleteItem(this->hashTable, dummyPtr))
+		return false;
+	if (filter)
+		filter->remove(dummyPtr.getHash());
+	return true;
 
 }
 
@@ -191,37 +301,52 @@ bool HashTable<ItemType>::deleteItem(string& key)
 		A private function for deleteItem
 */
 template<class ItemType>
-bool HashTable<ItemType>::_deleteItem(DList<ItemType>* table, string& key, ItemType& item)
+bool HashTable<ItemType>::_deleteItem(DList<ItemType>* table, ItemType& item)
 {
-	int index = hash(key);
+	int index = hash(item);
 	// Remove item form the linked list
-	if (table[index].deleteNode(item))
+	if (table[index].deleteNode(item, item.getHash()))
 	{
-		if(table[index].getCount() == 1)
-			collision--;
+		// The bucket is now empty, or one fewer item collides in it
+		if(table[index].isEmpty())
+			counter--;
 		else
-			counter++;
+			collision--;
 		return true;
 	}
 	return false;
 }
 
+/* reserve:
+		rehash to fit n items if they would cross the threshold
+*/
+template<class ItemType>
+void HashTable<ItemType>::reserve(int n)
+{
+	if ((long long)n * 100 >= (long long)THRESHOLD * CAPACITY)
+		reHash((int)((long long)n * 100 / THRESHOLD) + 1);
+}
+
 /* reHash:
 		function for re-hashing
 */
 template<class ItemType>
-void HashTable<ItemType>::reHash()
+void HashTable<ItemType>::reHash(int minCapacity)
 {
 	int OLD_CAPACITY = CAPACITY;
 	int old_counter = counter;
-	CAPACITY = nextPrime(CAPACITY * 2);
+	CAPACITY = nextPrime(CAPACITY * 2 > minCapacity ? CAPACITY * 2 : minCapacity);
 	DList<ItemType>* oldTable = this->hashTable;
 	DList<ItemType>* newTable = new DList<ItemType>[CAPACITY];
+	for (int i = 0; i < CAPACITY; i++)
+		newTable[i].setMode(bucketMode);
 	ItemType linkedListItem;
-	string key;
 	// reset the counter
 	counter = 0;
 	collision = 0;
+	// the filter grows with the table
+	if (filter)
+		filter->reset(CAPACITY);
 	// Go through each item in the table
 	for (int i = 0, count = 0; i < OLD_CAPACITY && count < old_counter; i++)
 	{
@@ -231,9 +356,10 @@ void HashTable<ItemType>::reHash()
 			// get the item in index j
 			if (this->hashTable[i].getNodeAtIndex(j, linkedListItem))
 			{
-				key = linkedListItem.getKey();
-				// insert the the table
-				_insertItem(newTable, key, &linkedListItem);
+				// insert the the table, reusing the cached hash
+				if (filter)
+					filter->add(linkedListItem.getHash());
+				_insertNode(newTable, new ListNode<ItemType>(std::move(linkedListItem)));
 			}
 		}
 		if (this->hashTable[i].getCount() >= 1)
@@ -244,25 +370,34 @@ void HashTable<ItemType>::reHash()
 }
 
 template<class ItemType>
-void HashTable<ItemType>::printTable(void printHeader(), void printData(ItemType&))
+size_t HashTable<ItemType>::memoryUsage() const
+{
+	size_t bytes = CAPACITY * sizeof(DList<ItemType>);
+	for (int i = 0; i < CAPACITY; i++)
+		bytes += this->hashTable[i].memoryUsage();
+	if (filter)
+		bytes += filter->memoryUsage();
+	return bytes;
+}
+
+template<class ItemType>
+template<class Output>
+void HashTable<ItemType>::printTable(void printHeader(Output&), void printBucket(int, Output&), void printData(ItemType&, Output&), Output& out)
 {
-	printHeader();
+	printHeader(out);
 	for (int i = 0; i < CAPACITY; i++)
 	{
 		if(this->hashTable[i].getCount() > 0)
 		{
-			cout << "----------------------------------------" << i << "-------------------------------------" << endl;
-			this->hashTable[i].traverseForward(printData);
+			printBucket(i, out);
+			this->hashTable[i].traverseForward(printData, out);
 			/* For Debug, see if the keys in linked-list have the same hash key
 			if (hashTable[i].getCount() >= 2)
 			{
 				ItemType i1, i2;
-				string k1, k2;
 				hashTable[i].getNodeAtIndex(0, i1);
 				hashTable[i].getNodeAtIndex(1, i2);
-				k1 = i1.getKey();
-				k2 = i2.getKey();
-				cout << hash(k1) << " " << hash(k2) << endl;
+				cout << hash(i1) << " " << hash(i2) << endl;
 			}
 			*/
 		}
@@ -270,16 +405,16 @@ void HashTable<ItemType>::printTable(void printHeader(), void printData(ItemType
 	}
 }
 template<class ItemType>
-void HashTable<ItemType>::printInfo(void printHeader(), void printData(ItemType&))
+template<class Output>
+void HashTable<ItemType>::printInfo(void printHeader(Output&), void printBucket(int, Output&), void printData(ItemType&, Output&), Output& out)
 {
-	printHeader();
+	printHeader(out);
 	for (int i = 0; i < CAPACITY; i++)
 	{
 			//cout << i;
-			this->hashTable[i].traverseForward(printData);
-			cout << "----------------------------------------" << i << "-------------------------------------" << endl;
+			this->hashTable[i].traverseForward(printData, out);
+			printBucket(i, out);
 	}
-	cout << "Number of collisions: " << collision<< endl;
 }
 
 
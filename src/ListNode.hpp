@@ -4,6 +4,7 @@
 // IDE: Visual Studio
 
 #include <iostream>
+#include <utility>
 #ifndef LISTNODE_H
 #define LISTNODE_H
 
@@ -13,25 +14,42 @@ class ListNode
 {
 private:
 	T data;
+	unsigned long long fingerprint;	// Hash of the key, checked before comparing data
 	ListNode<T>* forw;
 	ListNode<T>* back;
 		
 public:
 	//Constructor
 	ListNode();
-	ListNode(T &value) {
+	ListNode(const T &value) : data(value) {
 		forw = NULL;
 		back = NULL;
-		data = value;
+		fingerprint = 0;
+	}
+	ListNode(T &&value) : data(std::move(value)) {
+		forw = NULL;
+		back = NULL;
+		fingerprint = 0;
+	}
+	// build the data in place from its constructor arguments
+	template<class... Args>
+	ListNode(std::in_place_t, Args&&... args) : data(std::forward<Args>(args)...) {
+		forw = NULL;
+		back = NULL;
+		fingerprint = 0;
 	}
 
 	//getters
-	T getData();
+	const T& getData() const { return data; }
+	T& getData() { return data; }
+	unsigned long long getFingerprint() const { return fingerprint; }
 	ListNode<T>* getForw();
 	ListNode<T>* getBack();
 
 	//setters
-	void setData(T&);
+	void setData(const T&);
+	void setData(T&&);
+	void setFingerprint(unsigned long long fp) { fingerprint = fp; }
 	void setBack(ListNode<T>*);
 	void setForw(ListNode<T>*);
 };
@@ -46,14 +64,7 @@ template <class T>
 ListNode<T>::ListNode() {
 	forw = NULL;
 	back = NULL;
-}
-
-//***********************************************************
-// Getter
-//***********************************************************
-template <class T>
-T ListNode<T>::getData() {
-	return data;
+	fingerprint = 0;
 }
 
 //***********************************************************
@@ -73,13 +84,21 @@ ListNode<T>* ListNode<T>::getBack() {
 }
 
 //***********************************************************
-// Getter
+// Setter
 //***********************************************************
 template <class T>
-void ListNode<T>::setData(T &value) {
+void ListNode<T>::setData(const T &value) {
 	 data = value;
 }
 
+//***********************************************************
+// Setter
+//***********************************************************
+template <class T>
+void ListNode<T>::setData(T &&value) {
+	 data = std::move(value);
+}
+
 //***********************************************************
 // Getter
 //***********************************************************
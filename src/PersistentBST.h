@@ -0,0 +1,318 @@
+// Persistent Binary Search Tree ADT
+// Every insert or remove builds a new version of the tree that shares the
+// nodes it did not touch with the version before it; only the nodes on
+// the path to the change are copied. A node never changes once it is
+// built, so a Version taken from the tree stays the same for as long as
+// it is held and can be read from any thread, without locks, while the
+// tree goes on changing. The tree is balanced as an AVL tree, so a change
+// copies O(log n) nodes. Only one thread at a time may change the tree.
+
+#ifndef _PERSISTENT_BST
+#define _PERSISTENT_BST
+
+#include "StackADT.h"
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <utility>
+
+template<class ItemType>
+class PersistentBST
+{
+private:
+	struct Node;
+	typedef std::shared_ptr<const Node> NodePtr;
+
+	struct Node
+	{
+		ItemType item;
+		NodePtr left;
+		NodePtr right;
+		int height;     // of the subtree, 1 for a leaf
+
+		Node(const ItemType& anItem, NodePtr leftPtr, NodePtr rightPtr)
+			: item(anItem), left(std::move(leftPtr)), right(std::move(rightPtr))
+		{
+			int leftHeight = left ? left->height : 0;
+			int rightHeight = right ? right->height : 0;
+			height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+		}
+	};
+
+	// The root and count of one version
+	struct State
+	{
+		NodePtr root;
+		int count;
+	};
+
+	// the latest version, swapped atomically so readers need no lock
+	std::shared_ptr<const State> latest;
+
+public:
+	// A read-only view of the tree as it was when the version was taken
+	class Version
+	{
+	private:
+		std::shared_ptr<const State> state;
+		friend class PersistentBST<ItemType>;
+		explicit Version(std::shared_ptr<const State> aState) : state(std::move(aState)) {}
+
+	public:
+		// an empty version
+		Version() {}
+
+		bool isEmpty() const { return size() == 0; }
+		int size() const { return state ? state->count : 0; }
+		bool getEntry(const ItemType& anEntry, ItemType& returnedItem) const;
+		void inOrder(void visit(ItemType&)) const;
+		// in order, handing each item to visit with an output of any type
+		template<class Output>
+		void inOrderOutput(void visit(ItemType&, Output&), Output& out) const;
+	};
+
+	PersistentBST() { std::atomic_store(&latest, std::shared_ptr<const State>(new State{ NodePtr(), 0 })); }
+	PersistentBST(const PersistentBST<ItemType>&) = delete;
+	PersistentBST<ItemType>& operator=(const PersistentBST<ItemType>&) = delete;
+
+	// the latest version, safe to call from any thread
+	Version current() const { return Version(std::atomic_load(&latest)); }
+	bool isEmpty() const { return size() == 0; }
+	int size() const { return std::atomic_load(&latest)->count; }
+	// heap bytes of the latest version; a node shares one allocation with
+	// its reference counts, and nodes only older versions hold are not counted
+	size_t memoryUsage() const { return sizeof(State) + size() * (sizeof(Node) + sizeof(void*) + 2 * sizeof(int)); }
+
+	// false if an equal item is in the tree already
+	bool insert(const ItemType& newEntry);
+	// false if no equal item is in the tree
+	bool remove(const ItemType& target);
+	bool getEntry(const ItemType& anEntry, ItemType& returnedItem) const { return current().getEntry(anEntry, returnedItem); }
+	void clear() { publish(NodePtr(), 0); }
+	// replace the tree with items, which must be sorted and distinct;
+	// builds a perfectly balanced tree in O(n)
+	void assignSorted(const std::vector<ItemType>& items);
+
+private:
+	void publish(NodePtr root, int count) { std::atomic_store(&latest, std::shared_ptr<const State>(new State{ std::move(root), count })); }
+
+	static int height(const NodePtr& nodePtr) { return nodePtr ? nodePtr->height : 0; }
+	// a new node over left and right, rotated if their heights differ by 2
+	static NodePtr balance(const ItemType& item, NodePtr left, NodePtr right);
+	static NodePtr _insert(const NodePtr& nodePtr, const ItemType& newEntry, bool& success);
+	static NodePtr _remove(const NodePtr& nodePtr, const ItemType& target, bool& success);
+	// the subtree without its leftmost node, whose item goes to smallest
+	static NodePtr removeLeftmost(const NodePtr& nodePtr, ItemType& smallest);
+	static NodePtr build(const std::vector<ItemType>& items, int first, int last);
+};
+
+///////////////////////// public function definitions ///////////////////////////
+
+//Inserting items, the new version is published once it is complete
+template<class ItemType>
+bool PersistentBST<ItemType>::insert(const ItemType& newEntry)
+{
+	std::shared_ptr<const State> state = std::atomic_load(&latest);
+	bool isSuccessful = false;
+	NodePtr root = _insert(state->root, newEntry, isSuccessful);
+	if (isSuccessful)
+		publish(std::move(root), state->count + 1);
+	return isSuccessful;
+}
+
+//Removing items
+template<class ItemType>
+bool PersistentBST<ItemType>::remove(const ItemType& target)
+{
+	std::shared_ptr<const State> state = std::atomic_load(&latest);
+	bool isSuccessful = false;
+	NodePtr root = _remove(state->root, target, isSuccessful);
+	if (isSuccessful)
+		publish(std::move(root), state->count - 1);
+	return isSuccessful;
+}
+
+//Building from sorted items
+template<class ItemType>
+void PersistentBST<ItemType>::assignSorted(const std::vector<ItemType>& items)
+{
+	publish(build(items, 0, (int)items.size() - 1), (int)items.size());
+}
+
+//Finding entries within a version
+template<class ItemType>
+bool PersistentBST<ItemType>::Version::getEntry(const ItemType& anEntry, ItemType& returnedItem) const
+{
+	const Node* nodePtr = state ? state->root.get() : nullptr;
+	while (nodePtr)
+	{
+		if (anEntry < nodePtr->item)
+			nodePtr = nodePtr->left.get();
+		else if (nodePtr->item < anEntry)
+			nodePtr = nodePtr->right.get();
+		else
+		{
+			returnedItem = nodePtr->item;
+			return true;
+		}
+	}
+	return false;
+}
+
+//Inorder traversal of a version, the version keeps its nodes alive
+template<class ItemType>
+void PersistentBST<ItemType>::Version::inOrder(void visit(ItemType&)) const
+{
+	Stack<const Node*> s;
+	const Node* nodePtr = state ? state->root.get() : nullptr;
+	ItemType item;
+	while (!s.isEmpty() || nodePtr)
+	{
+		if (nodePtr)
+		{
+			s.push(nodePtr);
+			nodePtr = nodePtr->left.get();
+		}
+		else
+		{
+			s.pop(nodePtr);
+			item = nodePtr->item;
+			visit(item);
+			nodePtr = nodePtr->right.get();
+		}
+	}
+}
+
+template<class ItemType>
+template<class Output>
+void PersistentBST<ItemType>::Version::inOrderOutput(void visit(ItemType&, Output&), Output& out) const
+{
+	Stack<const Node*> s;
+	const Node* nodePtr = state ? state->root.get() : nullptr;
+	ItemType item;
+	while (!s.isEmpty() || nodePtr)
+	{
+		if (nodePtr)
+		{
+			s.push(nodePtr);
+			nodePtr = nodePtr->left.get();
+		}
+		else
+		{
+			s.pop(nodePtr);
+			item = nodePtr->item;
+			visit(item, out);
+			nodePtr = nodePtr->right.get();
+		}
+	}
+}
+
+//////////////////////////// private functions ////////////////////////////////////////////
+
+//Rebalancing a new node, a single or double rotation like an AVL insert,
+//only the rotated nodes are copied
+template<class ItemType>
+typename PersistentBST<ItemType>::NodePtr PersistentBST<ItemType>::balance(const ItemType& item, NodePtr left, NodePtr right)
+{
+	int leftHeight = height(left);
+	int rightHeight = height(right);
+	if (leftHeight > rightHeight + 1)
+	{
+		// left heavy: rotate right, first rotating the left child left if its right side is taller
+		if (height(left->left) >= height(left->right))
+			return std::make_shared<const Node>(left->item, left->left,
+				std::make_shared<const Node>(item, left->right, std::move(right)));
+		const Node* pivot = left->right.get();
+		return std::make_shared<const Node>(pivot->item,
+			std::make_shared<const Node>(left->item, left->left, pivot->left),
+			std::make_shared<const Node>(item, pivot->right, std::move(right)));
+	}
+	if (rightHeight > leftHeight + 1)
+	{
+		if (height(right->right) >= height(right->left))
+			return std::make_shared<const Node>(right->item,
+				std::make_shared<const Node>(item, std::move(left), right->left), right->right);
+		const Node* pivot = right->left.get();
+		return std::make_shared<const Node>(pivot->item,
+			std::make_shared<const Node>(item, std::move(left), pivot->left),
+			std::make_shared<const Node>(right->item, pivot->right, right->right));
+	}
+	return std::make_shared<const Node>(item, std::move(left), std::move(right));
+}
+
+//Implementation of the insert operation, copies the path down to the new leaf
+//and returns the root of the new subtree (nodePtr itself if nothing changed)
+template<class ItemType>
+typename PersistentBST<ItemType>::NodePtr PersistentBST<ItemType>::_insert(const NodePtr& nodePtr, const ItemType& newEntry, bool& success)
+{
+	if (!nodePtr)
+	{
+		success = true;
+		return std::make_shared<const Node>(newEntry, NodePtr(), NodePtr());
+	}
+	if (newEntry < nodePtr->item)
+	{
+		NodePtr left = _insert(nodePtr->left, newEntry, success);
+		return success ? balance(nodePtr->item, std::move(left), nodePtr->right) : nodePtr;
+	}
+	if (nodePtr->item < newEntry)
+	{
+		NodePtr right = _insert(nodePtr->right, newEntry, success);
+		return success ? balance(nodePtr->item, nodePtr->left, std::move(right)) : nodePtr;
+	}
+	return nodePtr;
+}
+
+//Implementation of the remove operation, a node with two children takes
+//the smallest item of its right subtree
+template<class ItemType>
+typename PersistentBST<ItemType>::NodePtr PersistentBST<ItemType>::_remove(const NodePtr& nodePtr, const ItemType& target, bool& success)
+{
+	if (!nodePtr)
+		return nodePtr;
+	if (target < nodePtr->item)
+	{
+		NodePtr left = _remove(nodePtr->left, target, success);
+		return success ? balance(nodePtr->item, std::move(left), nodePtr->right) : nodePtr;
+	}
+	if (nodePtr->item < target)
+	{
+		NodePtr right = _remove(nodePtr->right, target, success);
+		return success ? balance(nodePtr->item, nodePtr->left, std::move(right)) : nodePtr;
+	}
+
+	success = true;
+	if (!nodePtr->left)
+		return nodePtr->right;
+	if (!nodePtr->right)
+		return nodePtr->left;
+	ItemType smallest;
+	NodePtr right = removeLeftmost(nodePtr->right, smallest);
+	return balance(smallest, nodePtr->left, std::move(right));
+}
+
+template<class ItemType>
+typename PersistentBST<ItemType>::NodePtr PersistentBST<ItemType>::removeLeftmost(const NodePtr& nodePtr, ItemType& smallest)
+{
+	if (!nodePtr->left)
+	{
+		smallest = nodePtr->item;
+		return nodePtr->right;
+	}
+	NodePtr left = removeLeftmost(nodePtr->left, smallest);
+	return balance(nodePtr->item, std::move(left), nodePtr->right);
+}
+
+//Building the subtree of items[first..last] around its middle item
+template<class ItemType>
+typename PersistentBST<ItemType>::NodePtr PersistentBST<ItemType>::build(const std::vector<ItemType>& items, int first, int last)
+{
+	if (first > last)
+		return NodePtr();
+	int middle = first + (last - first) / 2;
+	NodePtr left = build(items, first, middle - 1);
+	NodePtr right = build(items, middle + 1, last);
+	return std::make_shared<const Node>(items[middle], std::move(left), std::move(right));
+}
+
+#endif
@@ -0,0 +1,20 @@
+// Cache prefetch hint shared by the index structures
+// Expands to nothing on compilers without a prefetch builtin
+
+#ifndef _PREFETCH_H
+#define _PREFETCH_H
+
+#if defined(__GNUC__) || defined(__clang__)
+// hint that addr will be read soon, keep it in all cache levels
+#define PREFETCH_READ(addr) __builtin_prefetch((addr), 0, 3)
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define PREFETCH_READ(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
+#else
+#define PREFETCH_READ(addr) ((void)(addr))
+#endif
+
+// number of independent lookups a batched search keeps in flight
+static const int PREFETCH_GROUP = 16;
+
+#endif
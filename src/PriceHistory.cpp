@@ -0,0 +1,321 @@
+// Implementation file for the PriceHistory class
+
+#include "PriceHistory.h"
+#include <cstring>
+
+namespace
+{
+	// Reads back the bit stream of a block
+	class BitReader
+	{
+	private:
+		const unsigned long long* words;
+		size_t pos;
+
+	public:
+		BitReader(const unsigned long long* w) { words = w; pos = 0; }
+
+		unsigned long long read(int bits)
+		{
+			unsigned long long value = 0;
+			while (bits > 0)
+			{
+				int offset = (int)(pos & 63);
+				int take = 64 - offset < bits ? 64 - offset : bits;
+				unsigned long long word = words[pos >> 6] << offset;
+				value = (take == 64 ? 0 : value << take) | (word >> (64 - take));
+				pos += take;
+				bits -= take;
+			}
+			return value;
+		}
+	};
+
+	unsigned long long toBits(double value)
+	{
+		unsigned long long bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	double fromBits(unsigned long long bits)
+	{
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// x is never 0
+#if defined(__GNUC__) || defined(__clang__)
+	int leadingZeros(unsigned long long x) { return __builtin_clzll(x); }
+	int trailingZeros(unsigned long long x) { return __builtin_ctzll(x); }
+#else
+	int leadingZeros(unsigned long long x)
+	{
+		int n = 0;
+		while (!(x & (1ULL << 63))) { x <<= 1; n++; }
+		return n;
+	}
+	int trailingZeros(unsigned long long x)
+	{
+		int n = 0;
+		while (!(x & 1)) { x >>= 1; n++; }
+		return n;
+	}
+#endif
+}
+
+//**************************************************
+// Constructor
+//**************************************************
+PriceHistory::PriceHistory()
+{
+	count = 0;
+	prevDelta = 0;
+	prevBits = 0;
+	prevLeading = prevTrailing = -1;
+}
+
+//**************************************************
+// append starts a block with the raw timestamp and
+// price, later points are encoded against the one
+// before them
+//**************************************************
+bool PriceHistory::append(long long timestamp, double price)
+{
+	if (count > 0 && timestamp < blocks.back().lastTime)
+		return false;
+
+	if (blocks.empty() || blocks.back().count == BLOCK_POINTS)
+	{
+		// the full block will not grow any more
+		if (!blocks.empty())
+			blocks.back().words.shrink_to_fit();
+		blocks.emplace_back();
+		Block& block = blocks.back();
+		block.firstTime = timestamp;
+		block.count = 0;
+		block.bitCount = 0;
+		writeBits(block, (unsigned long long)timestamp, 64);
+		writeBits(block, toBits(price), 64);
+		prevDelta = 0;
+		prevBits = toBits(price);
+		prevLeading = prevTrailing = -1;
+	}
+	else
+	{
+		writeTimestamp(blocks.back(), timestamp);
+		writePrice(blocks.back(), price);
+	}
+
+	Block& block = blocks.back();
+	block.lastTime = timestamp;
+	block.count++;
+	count++;
+	return true;
+}
+
+//**************************************************
+// writeBits appends the low bits of value
+//**************************************************
+void PriceHistory::writeBits(Block& block, unsigned long long value, int bits)
+{
+	while (bits > 0)
+	{
+		int offset = (int)(block.bitCount & 63);
+		if (offset == 0)
+			block.words.push_back(0);
+		int take = 64 - offset < bits ? 64 - offset : bits;
+		// the next take bits of value, from its high end
+		unsigned long long chunk = (value >> (bits - take)) & (take == 64 ? ~0ULL : (1ULL << take) - 1);
+		block.words.back() |= chunk << (64 - offset - take);
+		block.bitCount += take;
+		bits -= take;
+	}
+}
+
+//**************************************************
+// writeTimestamp stores the delta of delta:
+// 0 in 1 bit, then 7, 9 or 12 bit values behind a
+// 2 to 4 bit prefix, anything else in 64 bits
+//**************************************************
+void PriceHistory::writeTimestamp(Block& block, long long timestamp)
+{
+	long long delta = timestamp - block.lastTime;
+	long long dod = delta - prevDelta;
+	prevDelta = delta;
+	if (dod == 0)
+		writeBits(block, 0, 1);
+	else if (dod >= -63 && dod <= 64)
+	{
+		writeBits(block, 2, 2);
+		writeBits(block, (unsigned long long)(dod + 63), 7);
+	}
+	else if (dod >= -255 && dod <= 256)
+	{
+		writeBits(block, 6, 3);
+		writeBits(block, (unsigned long long)(dod + 255), 9);
+	}
+	else if (dod >= -2047 && dod <= 2048)
+	{
+		writeBits(block, 14, 4);
+		writeBits(block, (unsigned long long)(dod + 2047), 12);
+	}
+	else
+	{
+		writeBits(block, 15, 4);
+		writeBits(block, (unsigned long long)dod, 64);
+	}
+}
+
+//**************************************************
+// writePrice stores the XOR with the last price:
+// 0 in 1 bit, or its meaningful bits, inside the
+// last window if they fit, else with a new window
+// (5 bits of leading zeros, 6 bits of length)
+//**************************************************
+void PriceHistory::writePrice(Block& block, double price)
+{
+	unsigned long long bits = toBits(price);
+	unsigned long long x = bits ^ prevBits;
+	prevBits = bits;
+	if (x == 0)
+	{
+		writeBits(block, 0, 1);
+		return;
+	}
+
+	int leading = leadingZeros(x);
+	int trailing = trailingZeros(x);
+	if (leading > 31)
+		leading = 31;
+	if (prevLeading >= 0 && leading >= prevLeading && trailing >= prevTrailing)
+	{
+		writeBits(block, 2, 2);
+		writeBits(block, x >> prevTrailing, 64 - prevLeading - prevTrailing);
+		return;
+	}
+
+	int length = 64 - leading - trailing;
+	writeBits(block, 3, 2);
+	writeBits(block, (unsigned long long)leading, 5);
+	writeBits(block, (unsigned long long)(length - 1), 6);
+	writeBits(block, x >> trailing, length);
+	prevLeading = leading;
+	prevTrailing = trailing;
+}
+
+//**************************************************
+// scan decodes the blocks overlapping [from, to]
+//**************************************************
+template<class Visit>
+void PriceHistory::scan(long long from, long long to, Visit visit) const
+{
+	for (const Block& block : blocks)
+	{
+		if (block.lastTime < from)
+			continue;
+		if (block.firstTime > to)
+			break;
+
+		BitReader reader(block.words.data());
+		long long timestamp = (long long)reader.read(64);
+		unsigned long long bits = reader.read(64);
+		long long delta = 0;
+		int leading = -1, trailing = -1;
+		for (int i = 0; i < block.count; i++)
+		{
+			if (i > 0)
+			{
+				long long dod;
+				if (reader.read(1) == 0)
+					dod = 0;
+				else if (reader.read(1) == 0)
+					dod = (long long)reader.read(7) - 63;
+				else if (reader.read(1) == 0)
+					dod = (long long)reader.read(9) - 255;
+				else if (reader.read(1) == 0)
+					dod = (long long)reader.read(12) - 2047;
+				else
+					dod = (long long)reader.read(64);
+				delta += dod;
+				timestamp += delta;
+
+				if (reader.read(1) == 1)
+				{
+					if (reader.read(1) == 1)
+					{
+						leading = (int)reader.read(5);
+						int length = (int)reader.read(6) + 1;
+						trailing = 64 - leading - length;
+					}
+					bits ^= reader.read(64 - leading - trailing) << trailing;
+				}
+			}
+			if (timestamp > to)
+				return;
+			if (timestamp >= from)
+				visit(Point{ timestamp, fromBits(bits) });
+		}
+	}
+}
+
+//**************************************************
+// range
+//**************************************************
+int PriceHistory::range(long long from, long long to, vector<Point>& points) const
+{
+	points.clear();
+	scan(from, to, [&](const Point& point) { points.push_back(point); });
+	return (int)points.size();
+}
+
+//**************************************************
+// downsample folds the points of each interval into
+// a bar
+//**************************************************
+int PriceHistory::downsample(long long from, long long to, long long width, vector<Bar>& bars) const
+{
+	bars.clear();
+	if (width <= 0)
+		return 0;
+	scan(from, to, [&](const Point& point)
+	{
+		long long start = from + (point.timestamp - from) / width * width;
+		if (bars.empty() || bars.back().timestamp != start)
+		{
+			bars.push_back(Bar{ start, point.price, point.price, point.price, point.price, 0 });
+		}
+		Bar& bar = bars.back();
+		if (point.price > bar.high)
+			bar.high = point.price;
+		if (point.price < bar.low)
+			bar.low = point.price;
+		bar.close = point.price;
+		bar.count++;
+	});
+	return (int)bars.size();
+}
+
+//**************************************************
+// memoryUsage
+//**************************************************
+size_t PriceHistory::memoryUsage() const
+{
+	size_t bytes = blocks.capacity() * sizeof(Block);
+	for (const Block& block : blocks)
+		bytes += block.words.capacity() * sizeof(unsigned long long);
+	return bytes;
+}
+
+//**************************************************
+// clear
+//**************************************************
+void PriceHistory::clear()
+{
+	blocks.clear();
+	count = 0;
+	prevDelta = 0;
+	prevBits = 0;
+	prevLeading = prevTrailing = -1;
+}
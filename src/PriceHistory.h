@@ -0,0 +1,81 @@
+// Specification file for the PriceHistory class
+// The prices of one coin over time, compressed the way Gorilla does it:
+// timestamps are stored as the change of their delta in a few bits, and
+// each price as the XOR with the price before it, keeping only its
+// meaningful bits. Points are kept in blocks that record their time
+// range, so a range query only decodes the blocks it overlaps.
+
+#ifndef PRICE_HISTORY_H
+#define PRICE_HISTORY_H
+#include <vector>
+#include <cstddef>
+
+using std::vector;
+
+class PriceHistory
+{
+public:
+	struct Point
+	{
+		long long timestamp;
+		double price;
+	};
+
+	// The points of one downsampling interval
+	struct Bar
+	{
+		long long timestamp;     // start of the interval
+		double open, high, low, close;
+		int count;
+	};
+
+	// Points per block
+	static const int BLOCK_POINTS = 256;
+
+	PriceHistory();
+
+	// add a point, false if it is older than the last one
+	bool append(long long timestamp, double price);
+
+	// the points with from <= timestamp <= to, oldest first; returns how many
+	int range(long long from, long long to, vector<Point>& points) const;
+	// the same points in intervals of width starting at from, empty intervals
+	// are left out; returns how many bars
+	int downsample(long long from, long long to, long long width, vector<Bar>& bars) const;
+
+	int getCount() const { return count; }
+	bool isEmpty() const { return count == 0; }
+	long long getFirstTime() const { return count ? blocks.front().firstTime : 0; }
+	long long getLastTime() const { return count ? blocks.back().lastTime : 0; }
+	// heap bytes held by the blocks
+	size_t memoryUsage() const;
+	void clear();
+
+private:
+	struct Block
+	{
+		long long firstTime;
+		long long lastTime;
+		int count;
+		vector<unsigned long long> words;   // the bit stream, filled from the high bit down
+		size_t bitCount;
+	};
+
+	vector<Block> blocks;
+	int count;
+
+	// Encoder state for the last block
+	long long prevDelta;
+	unsigned long long prevBits;      // bits of the last price
+	int prevLeading;                  // meaningful bit window of the last XOR
+	int prevTrailing;                 // written with its own window, -1 if none
+
+	static void writeBits(Block& block, unsigned long long value, int bits);
+	void writeTimestamp(Block& block, long long timestamp);
+	void writePrice(Block& block, double price);
+
+	// call visit(point) for the points in [from, to], oldest first
+	template<class Visit>
+	void scan(long long from, long long to, Visit visit) const;
+};
+#endif
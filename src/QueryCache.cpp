@@ -0,0 +1,108 @@
+// Implementation file for the QueryCache class
+
+#include "QueryCache.h"
+#include <iterator>
+#include <utility>
+
+//**************************************************
+// Constructor
+//**************************************************
+QueryCache::QueryCache(size_t entryLimit, size_t itemLimit)
+{
+	maxEntries = entryLimit;
+	maxItems = itemLimit;
+	items = 0;
+	hits = 0;
+	misses = 0;
+}
+
+//**************************************************
+// find moves a found entry to the front
+//**************************************************
+const vector<CryptocurrencyPtr>* QueryCache::find(Kind kind, const string& query)
+{
+	std::unordered_map<string, std::list<Entry>::iterator>::iterator found = index.find(keyOf(kind, query));
+	if (found == index.end())
+	{
+		misses++;
+		return nullptr;
+	}
+	hits++;
+	entries.splice(entries.begin(), entries, found->second);
+	return &found->second->results;
+}
+
+//**************************************************
+// store
+//**************************************************
+const vector<CryptocurrencyPtr>* QueryCache::store(Kind kind, const string& query, vector<CryptocurrencyPtr>& results)
+{
+	string key = keyOf(kind, query);
+	std::unordered_map<string, std::list<Entry>::iterator>::iterator found = index.find(key);
+	if (found != index.end())
+		erase(found->second);
+	if (results.size() > maxItems || maxEntries == 0)
+		return nullptr;
+
+	entries.push_front(Entry{ key, kind, std::move(results) });
+	index[key] = entries.begin();
+	items += entries.front().results.size();
+	// the new entry is first and fits alone, so it is never the one dropped
+	while (entries.size() > maxEntries || items > maxItems)
+		erase(std::prev(entries.end()));
+	return &entries.front().results;
+}
+
+//**************************************************
+// coinChanged; searches for other algorithms do not
+// hold the coin and stay
+//**************************************************
+void QueryCache::coinChanged(const string& alg)
+{
+	std::unordered_map<string, std::list<Entry>::iterator>::iterator found = index.find(keyOf(BY_ALG, alg));
+	if (found != index.end())
+		erase(found->second);
+	for (std::list<Entry>::iterator entry = entries.begin(); entry != entries.end();)
+	{
+		std::list<Entry>::iterator next = std::next(entry);
+		if (entry->kind != BY_ALG)
+			erase(entry);
+		entry = next;
+	}
+}
+
+//**************************************************
+// clear
+//**************************************************
+void QueryCache::clear()
+{
+	entries.clear();
+	index.clear();
+	items = 0;
+}
+
+//**************************************************
+// memoryUsage
+//**************************************************
+size_t QueryCache::memoryUsage() const
+{
+	size_t bytes = 0;
+	for (const Entry& entry : entries)
+		bytes += sizeof(Entry) + 2 * sizeof(void*) + entry.key.capacity() + entry.results.capacity() * sizeof(CryptocurrencyPtr);
+	return bytes + index.bucket_count() * sizeof(void*) + index.size() * (sizeof(string) + 2 * sizeof(void*));
+}
+
+//**************************************************
+// keyOf puts the kind in front of the query
+//**************************************************
+string QueryCache::keyOf(Kind kind, const string& query)
+{
+	return string(1, (char)('0' + kind)) + query;
+}
+
+void QueryCache::erase(std::list<Entry>::iterator entry)
+{
+	items -= entry->results.size();
+	index.erase(entry->key);
+	entries.erase(entry);
+}
@@ -0,0 +1,69 @@
+// Specification file for the QueryCache class
+// Keeps the results of recent searches by algorithm, of the sorted
+// listings and of pages of the name listing, so asking the same query
+// again between changes does not walk a tree. The entries are dropped least recently used first once there are
+// more than maxEntries of them or more than maxItems coins held in all.
+// A cached result points at the coins, so changes to the fields that are
+// not keys (price, supply, year, founder) show without invalidating it;
+// adding or removing a coin, or changing its name or algorithm, must be
+// told to the cache with coinChanged.
+
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+#include "Crypto.h"
+#include <vector>
+#include <string>
+#include <list>
+#include <unordered_map>
+
+using std::vector;
+using std::string;
+
+class QueryCache
+{
+public:
+	enum Kind { BY_ALG, SORTED_BY_NAME, SORTED_BY_ALG, PAGE_BY_NAME };
+
+	static const size_t DEFAULT_ENTRIES = 64;
+	static const size_t DEFAULT_ITEMS = 1 << 18;
+
+	explicit QueryCache(size_t maxEntries = DEFAULT_ENTRIES, size_t maxItems = DEFAULT_ITEMS);
+
+	// the cached result of a query, nullptr if it is not cached; the
+	// result stays valid until the next store or change
+	const vector<CryptocurrencyPtr>* find(Kind kind, const string& query);
+	// keep a result, moved out of results; returns the kept result, or
+	// nullptr with results left as they were if it is larger than maxItems
+	const vector<CryptocurrencyPtr>* store(Kind kind, const string& query, vector<CryptocurrencyPtr>& results);
+	// a coin with algorithm alg was added or removed, or its name or
+	// algorithm changed: drops the search for alg, both listings and
+	// every page, since a page shifts with any coin before it
+	void coinChanged(const string& alg);
+	void clear();
+
+	int getEntryCount() const { return (int)entries.size(); }
+	long long getHits() const { return hits; }
+	long long getMisses() const { return misses; }
+	// heap bytes held by the entries
+	size_t memoryUsage() const;
+
+private:
+	struct Entry
+	{
+		string key;
+		Kind kind;
+		vector<CryptocurrencyPtr> results;
+	};
+
+	size_t maxEntries;
+	size_t maxItems;
+	size_t items;           // coins held by all entries
+	long long hits;
+	long long misses;
+	std::list<Entry> entries;   // most recently used first
+	std::unordered_map<string, std::list<Entry>::iterator> index;
+
+	static string keyOf(Kind kind, const string& query);
+	void erase(std::list<Entry>::iterator entry);
+};
+#endif
@@ -0,0 +1,513 @@
+// Implementation file for the QueryServer class
+
+#include "QueryServer.h"
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <climits>
+#include <cstdint>
+#include <cerrno>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Reads the fields of a frame; a field past the end clears ok,
+	// and complete() also refuses bytes left after the last field
+	struct FrameReader
+	{
+		const char* p;
+		size_t left;
+		bool ok;
+
+		FrameReader(const char* frame, size_t length) : p(frame), left(length), ok(true) {}
+
+		bool complete() const { return ok && left == 0; }
+
+		unsigned long long number(int bytes)
+		{
+			unsigned long long value = 0;
+			if (left < (size_t)bytes)
+			{
+				ok = false;
+				return 0;
+			}
+			for (int i = 0; i < bytes; i++)
+				value |= (unsigned long long)(unsigned char)p[i] << (8 * i);
+			p += bytes;
+			left -= bytes;
+			return value;
+		}
+
+		string text()
+		{
+			size_t length = (size_t)number(2);
+			if (!ok || left < length)
+			{
+				ok = false;
+				return string();
+			}
+			string value(p, length);
+			p += length;
+			left -= length;
+			return value;
+		}
+
+		double real()
+		{
+			unsigned long long bits = number(8);
+			double value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+	};
+
+	void putNumber(string& out, unsigned long long value, int bytes)
+	{
+		for (int i = 0; i < bytes; i++)
+		{
+			out.push_back((char)(value & 0xff));
+			value >>= 8;
+		}
+	}
+
+	// longer strings are cut to what a uint16 length can hold
+	void putText(string& out, const string& text)
+	{
+		size_t length = text.size() < 0xffff ? text.size() : 0xffff;
+		putNumber(out, length, 2);
+		out.append(text, 0, length);
+	}
+
+	void putCoin(string& out, const Cryptocurrency& crypto)
+	{
+		unsigned long long priceBits;
+		double price = crypto.getPrice();
+		memcpy(&priceBits, &price, sizeof(priceBits));
+		putText(out, crypto.getName());
+		putText(out, crypto.getAlg());
+		putNumber(out, (unsigned long long)crypto.getSupply(), 8);
+		putText(out, crypto.getFounder());
+		putNumber(out, (unsigned long long)(unsigned)crypto.getDate(), 4);
+		putNumber(out, priceBits, 8);
+	}
+}
+
+//**************************************************
+// Constructor
+//**************************************************
+QueryServer::QueryServer(ShardedDatabase& db, const string& socketPath)
+	: database(db), path(socketPath)
+{
+	listener = -1;
+	epoll = -1;
+	signals = -1;
+	requests = 0;
+}
+
+//**************************************************
+// Destructor
+//**************************************************
+QueryServer::~QueryServer()
+{
+#ifdef __linux__
+	while (!connections.empty())
+		close(connections.begin()->second);
+	if (listener >= 0)
+	{
+		::close(listener);
+		unlink(path.c_str());
+	}
+	if (epoll >= 0)
+		::close(epoll);
+	if (signals >= 0)
+		::close(signals);
+#endif
+}
+
+//**************************************************
+// run is the event loop; the epoll events are level
+// triggered, so a connection that still has work is
+// reported again on the next wait
+//**************************************************
+bool QueryServer::run()
+{
+#ifdef __linux__
+	const int MAX_EVENTS = 64;
+	epoll_event events[MAX_EVENTS];
+	bool stopping = false;
+
+	if (!listen())
+		return false;
+	while (!stopping)
+	{
+		int ready = epoll_wait(epoll, events, MAX_EVENTS, -1);
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			fail("epoll_wait");
+			break;
+		}
+		for (int i = 0; i < ready; i++)
+		{
+			int fd = events[i].data.fd;
+			if (fd == signals)
+				stopping = true;
+			else if (fd == listener)
+				accept();
+			else
+			{
+				std::unordered_map<int, Connection*>::iterator found = connections.find(fd);
+				if (found == connections.end())
+					continue;
+				if (!serve(*found->second, events[i].events))
+					close(found->second);
+			}
+		}
+	}
+	return error.empty();
+#else
+	error = "the server needs Linux (epoll)";
+	return false;
+#endif
+}
+
+#ifdef __linux__
+
+//**************************************************
+// listen binds the socket, a socket left behind by
+// an earlier server at the path is replaced
+//**************************************************
+bool QueryServer::listen()
+{
+	sockaddr_un address;
+	struct stat status;
+	sigset_t mask;
+	epoll_event event;
+
+	if (path.size() >= sizeof(address.sun_path))
+	{
+		error = "socket path too long: " + path;
+		return false;
+	}
+	if (stat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+		unlink(path.c_str());
+
+	// the signals are read from a descriptor in the loop instead of a handler
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+	signals = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (signals < 0)
+	{
+		fail("signalfd");
+		return false;
+	}
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		fail("socket");
+		return false;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	memcpy(address.sun_path, path.c_str(), path.size() + 1);
+	if (bind(fd, (sockaddr*)&address, sizeof(address)) < 0)
+	{
+		fail("bind " + path);
+		::close(fd);
+		return false;
+	}
+	// from here on the destructor removes the socket file
+	listener = fd;
+	if (::listen(listener, SOMAXCONN) < 0)
+	{
+		fail("listen");
+		return false;
+	}
+
+	epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll < 0)
+	{
+		fail("epoll_create1");
+		return false;
+	}
+	event.events = EPOLLIN;
+	event.data.fd = listener;
+	epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+	event.data.fd = signals;
+	epoll_ctl(epoll, EPOLL_CTL_ADD, signals, &event);
+	return true;
+}
+
+//**************************************************
+// accept takes every waiting client
+//**************************************************
+void QueryServer::accept()
+{
+	int fd;
+	while ((fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		epoll_event event;
+		Connection* connection = new Connection;
+		connection->fd = fd;
+		connection->reading = true;
+		connection->writing = false;
+		connection->ended = false;
+		event.events = EPOLLIN;
+		event.data.fd = fd;
+		if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+		{
+			::close(fd);
+			delete connection;
+			continue;
+		}
+		connections[fd] = connection;
+	}
+}
+
+//**************************************************
+// serve; a client that ends its side after sending
+// still gets the replies to all it sent
+//**************************************************
+bool QueryServer::serve(Connection& connection, unsigned events)
+{
+	if (events & EPOLLERR)
+		return false;
+	if ((events & (EPOLLIN | EPOLLHUP)) && !connection.ended && !receive(connection))
+		return false;
+	// answer stops at MAX_PENDING; once send makes room the frames left
+	// are answered too, no more events may come for them
+	do
+	{
+		if (!answer(connection) || !send(connection))
+			return false;
+	} while (connection.out.size() < MAX_PENDING && hasFrame(connection.in));
+	if (connection.ended && connection.out.empty())
+		return false;
+	watch(connection);
+	return true;
+}
+
+//**************************************************
+// receive reads once, level triggered epoll reports
+// the connection again if more is waiting
+//**************************************************
+bool QueryServer::receive(Connection& connection)
+{
+	char buffer[1 << 16];
+	ssize_t got = read(connection.fd, buffer, sizeof(buffer));
+	if (got == 0)
+	{
+		connection.ended = true;
+		return true;
+	}
+	if (got < 0)
+		return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+	connection.in.append(buffer, (size_t)got);
+	return true;
+}
+
+//**************************************************
+// send writes until the socket is full
+//**************************************************
+bool QueryServer::send(Connection& connection)
+{
+	size_t sent = 0;
+	while (sent < connection.out.size())
+	{
+		ssize_t wrote = ::send(connection.fd, connection.out.data() + sent, connection.out.size() - sent, MSG_NOSIGNAL);
+		if (wrote < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				return false;
+			break;
+		}
+		sent += (size_t)wrote;
+	}
+	connection.out.erase(0, sent);
+	return true;
+}
+
+//**************************************************
+// answer
+//**************************************************
+bool QueryServer::answer(Connection& connection)
+{
+	size_t used = 0;
+	bool good = true;
+	while (connection.out.size() < MAX_PENDING && connection.in.size() - used >= 4)
+	{
+		FrameReader header(connection.in.data() + used, 4);
+		size_t length = (size_t)header.number(4);
+		if (length > MAX_FRAME || length < 5)
+		{
+			good = false;
+			break;
+		}
+		if (connection.in.size() - used - 4 < length)
+			break;
+		handle(connection.in.data() + used + 4, length, connection.out);
+		used += 4 + length;
+	}
+	connection.in.erase(0, used);
+	return good;
+}
+
+//**************************************************
+// hasFrame is true when in starts with a whole frame,
+// or with a length answer rejects
+//**************************************************
+bool QueryServer::hasFrame(const string& in)
+{
+	if (in.size() < 4)
+		return false;
+	FrameReader header(in.data(), 4);
+	size_t length = (size_t)header.number(4);
+	return length > MAX_FRAME || length < 5 || in.size() - 4 >= length;
+}
+
+//**************************************************
+// watch; writing stays on while frames wait to be
+// answered, so a drained socket brings them back
+//**************************************************
+void QueryServer::watch(Connection& connection)
+{
+	bool reading = !connection.ended && connection.out.size() < MAX_PENDING;
+	bool writing = !connection.out.empty() || hasFrame(connection.in);
+	if (reading == connection.reading && writing == connection.writing)
+		return;
+	epoll_event event;
+	event.events = (reading ? static_cast<uint32_t>(EPOLLIN) : 0u) | (writing ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+	event.data.fd = connection.fd;
+	epoll_ctl(epoll, EPOLL_CTL_MOD, connection.fd, &event);
+	connection.reading = reading;
+	connection.writing = writing;
+}
+
+//**************************************************
+// close
+//**************************************************
+void QueryServer::close(Connection* connection)
+{
+	epoll_ctl(epoll, EPOLL_CTL_DEL, connection->fd, nullptr);
+	::close(connection->fd);
+	connections.erase(connection->fd);
+	delete connection;
+}
+
+#endif
+
+//**************************************************
+// handle answers one request; the reply's length is
+// filled in once its body is written
+//**************************************************
+void QueryServer::handle(const char* frame, size_t length, string& reply)
+{
+	FrameReader request(frame, length);
+	int op = (int)request.number(1);
+	unsigned long long id = request.number(4);
+	size_t start = reply.size();
+	Status status = OK;
+	Cryptocurrency found;
+
+	putNumber(reply, 0, 4);
+	putNumber(reply, 0, 1);
+	putNumber(reply, id, 4);
+	requests++;
+
+	switch (op)
+	{
+	case LOOKUP:
+	{
+		string name = request.text();
+		if (!request.complete())
+			status = BAD_REQUEST;
+		else if (!database.find(name, found))
+			status = NOT_FOUND;
+		else
+			putCoin(reply, found);
+		break;
+	}
+	case RANGE:
+	{
+		string first = request.text();
+		string last = request.text();
+		unsigned long long limit = request.number(4);
+		std::vector<Cryptocurrency> cryptos;
+		if (!request.complete() || !FixedKey::fits(first) || !FixedKey::fits(last))
+		{
+			status = BAD_REQUEST;
+			break;
+		}
+		// no database holds more than INT_MAX coins, a larger limit is no limit
+		database.rangeByName(first, last, cryptos, limit > INT_MAX ? 0 : (int)limit);
+		putNumber(reply, cryptos.size(), 4);
+		for (const Cryptocurrency& crypto : cryptos)
+			putCoin(reply, crypto);
+		break;
+	}
+	case INSERT:
+	{
+		string name = request.text();
+		string alg = request.text();
+		long long supply = (long long)request.number(8);
+		string founder = request.text();
+		int year = (int)(unsigned)request.number(4);
+		double price = request.real();
+		// the same rules the console's validators apply
+		if (!request.complete() || name.empty() || alg.empty() || !FixedKey::fits(name) || !FixedKey::fits(alg)
+			|| supply < 0 || supply > INT_MAX || year < 1950 || year > 2019 || !(price >= 0) || !std::isfinite(price))
+		{
+			status = BAD_REQUEST;
+			break;
+		}
+		Cryptocurrency* crypto = new Cryptocurrency(name, alg, supply, year, price, founder);
+		if (!database.insert(crypto))
+		{
+			delete crypto;
+			status = EXISTS;
+		}
+		break;
+	}
+	case REMOVE:
+	{
+		string name = request.text();
+		if (!request.complete())
+			status = BAD_REQUEST;
+		else if (!database.remove(name))
+			status = NOT_FOUND;
+		break;
+	}
+	default:
+		status = BAD_REQUEST;
+	}
+
+	// a failed request has no body
+	if (status != OK)
+		reply.resize(start + 9);
+	reply[start + 4] = (char)status;
+	for (int i = 0; i < 4; i++)
+		reply[start + i] = (char)(((reply.size() - start - 4) >> (8 * i)) & 0xff);
+}
+
+//**************************************************
+// fail
+//**************************************************
+void QueryServer::fail(const string& what)
+{
+	error = what + ": " + strerror(errno);
+}
@@ -0,0 +1,87 @@
+// Specification file for the QueryServer class
+// Serves a ShardedDatabase to other processes over a Unix-domain socket.
+// One thread runs an epoll loop over the listening socket and every
+// client; a client may send many requests without waiting, they are
+// answered in order. Names are matched exactly as sent.
+//
+// Every message is a frame, all numbers little-endian:
+//   uint32 length of the rest, uint8 op or status, uint32 request id, body
+// Strings are a uint16 length followed by the bytes. A coin is
+//   name, algorithm, int64 supply, founder, int32 year, float64 price
+// Requests:
+//   LOOKUP  name                          -> coin
+//   RANGE   first, last, uint32 limit     -> uint32 count, coins sorted by
+//                                            name (0 limit: all of them)
+//   INSERT  coin                          -> nothing
+//   REMOVE  name                          -> nothing
+// The reply has the id of its request and a status. A frame longer than
+// MAX_FRAME or too short for an op and an id closes the connection.
+// Only built on Linux; elsewhere run reports that it is not supported.
+
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+#include "ShardedDatabase.h"
+#include <string>
+#include <unordered_map>
+
+using std::string;
+
+class QueryServer
+{
+public:
+	enum Op { LOOKUP = 1, RANGE = 2, INSERT = 3, REMOVE = 4 };
+	enum Status { OK = 0, NOT_FOUND = 1, EXISTS = 2, BAD_REQUEST = 3 };
+
+	static const size_t MAX_FRAME = 1 << 20;
+	// Replies a client may leave unread before its requests stop being read
+	static const size_t MAX_PENDING = 1 << 24;
+
+	QueryServer(ShardedDatabase& database, const string& socketPath);
+	~QueryServer();
+	QueryServer(const QueryServer&) = delete;
+	QueryServer& operator=(const QueryServer&) = delete;
+
+	// serve until SIGINT or SIGTERM, which are left blocked afterwards;
+	// false if the socket could not be set up
+	bool run();
+	int getRequestCount() const { return requests; }
+	// why run failed
+	const string& getError() const { return error; }
+
+private:
+	struct Connection
+	{
+		int fd;
+		string in;          // bytes received and not yet answered
+		string out;         // replies not yet sent
+		bool reading;       // the events asked for last time
+		bool writing;
+		bool ended;         // the client sent all it will, close once answered
+	};
+
+	ShardedDatabase& database;
+	string path;
+	string error;
+	int listener;
+	int epoll;
+	int signals;
+	int requests;
+	std::unordered_map<int, Connection*> connections;
+
+	bool listen();
+	void accept();
+	// read, answer and send what the events allow, false on a closed or bad connection
+	bool serve(Connection& connection, unsigned events);
+	bool receive(Connection& connection);
+	bool send(Connection& connection);
+	// answer the complete frames received until MAX_PENDING bytes of
+	// replies wait, false on a bad frame
+	bool answer(Connection& connection);
+	static bool hasFrame(const string& in);
+	void handle(const char* frame, size_t length, string& reply);
+	// ask for the events the buffers need
+	void watch(Connection& connection);
+	void close(Connection* connection);
+	void fail(const string& what);
+};
+#endif
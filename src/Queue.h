@@ -1,62 +1,157 @@
 /**~*~*
    Queue template
+   Values live in one growable ring buffer, so enqueue and
+   dequeue do not allocate once the buffer is big enough
 *~**/
 #ifndef DYNAMICQUEUE_H
 #define DYNAMICQUEUE_H
 #include <iostream>
+#include <new>
+#include <utility>
 using namespace std;
 
 template <class T>
 class Queue
 {
 private:
-   // Structure for the queue nodes
-   struct QueueNode
-   {
-      T value;          // Value in the node
-      QueueNode *next;  // Pointer to next node
-   };
-
-   QueueNode *front;    // Pointer to the queue front
-   QueueNode *rear;     // Pointer to the queue rear
+   T *buffer;        // Ring of capacity slots, only count of them hold values
+   int capacity;     // Always 0 or a power of two, so wrapping is a mask
+   int front;        // Slot of the value at the front
    int count;
 
+   // slot i positions behind the front
+   int slotAt(int i) const { return (front + i) & (capacity - 1); }
+   // make room for one more value
+   void makeRoom();
+   // move the values into a new buffer of newCapacity slots
+   void resize(int newCapacity);
+   // destroy the values, keeping the buffer
+   void destroyValues();
+   // destroy the values and release the buffer
+   void release();
+
 public:
    //Constructor
-   Queue(){front = rear = NULL; count = 0;}
+   Queue(){buffer = NULL; capacity = 0; front = 0; count = 0;}
+   Queue(const Queue<T> &);
 
    // Destructor
-   ~Queue();
+   ~Queue() { release(); }
+
+   Queue<T> &operator=(const Queue<T> &);
 
    // Stack operations
-   bool enqueue(T);
+   bool enqueue(const T &);
+   bool enqueue(T &&);
+   // build the value in place at the rear from its constructor arguments
+   template <class... Args>
+   bool emplace(Args&&... args);
    bool dequeue(T &);
    bool isEmpty();
    int  getCount();
    bool queueFront(T &);
    bool queueRear(T &);
+   // make room for at least n values without reallocating
+   void reserve(int n);
 };
 
 /**~*~*
-   Destructor
+   Copy constructor
+*~**/
+template <class T>
+Queue<T>::Queue(const Queue<T> &other)
+{
+   buffer = NULL; capacity = 0; front = 0; count = 0;
+   reserve(other.count);
+   for (int i = 0; i < other.count; i++)
+      enqueue(other.buffer[other.slotAt(i)]);
+}
+
+/**~*~*
+   Assignment operator
+*~**/
+template <class T>
+Queue<T> &Queue<T>::operator=(const Queue<T> &other)
+{
+   if (this != &other)
+   {
+      destroyValues();
+      reserve(other.count);
+      for (int i = 0; i < other.count; i++)
+         enqueue(other.buffer[other.slotAt(i)]);
+   }
+   return *this;
+}
+
+/**~*~*
+  Member function destroyValues empties the queue
+  in place.
 *~**/
 template <class T>
-Queue<T>::~Queue()
+void Queue<T>::destroyValues()
 {
-   QueueNode *currNode, *nextNode;
+   for (int i = 0; i < count; i++)
+      buffer[slotAt(i)].~T();
+   front = count = 0;
+}
 
-   // Position nodePtr at the top of the stack.
-   currNode = front;
+/**~*~*
+  Member function release destroys the values
+  and frees the buffer.
+*~**/
+template <class T>
+void Queue<T>::release()
+{
+   destroyValues();
+   ::operator delete(buffer);
+   buffer = NULL;
+   capacity = 0;
+}
 
-   // Traverse the list deleting each node.
-   while (currNode) //while (currNode != NULL)
+/**~*~*
+  Member function resize moves the values, front first,
+  to the start of a new buffer.
+*~**/
+template <class T>
+void Queue<T>::resize(int newCapacity)
+{
+   T *newBuffer = static_cast<T *>(::operator new(sizeof(T) * newCapacity));
+   for (int i = 0; i < count; i++)
    {
-      nextNode = currNode->next;
-      delete currNode;
-      currNode = nextNode;
+      T &value = buffer[slotAt(i)];
+      new (newBuffer + i) T(std::move(value));
+      value.~T();
    }
+   ::operator delete(buffer);
+   buffer = newBuffer;
+   capacity = newCapacity;
+   front = 0;
 }
 
+/**~*~*
+  Member function makeRoom doubles the buffer when it is full.
+*~**/
+template <class T>
+void Queue<T>::makeRoom()
+{
+   if (count == capacity)
+      resize(capacity == 0 ? 8 : capacity * 2);
+}
+
+/**~*~*
+  Member function reserve grows the buffer to the
+  smallest power of two that holds n values.
+*~**/
+template <class T>
+void Queue<T>::reserve(int n)
+{
+   if (n <= capacity)
+      return;
+   int newCapacity = capacity == 0 ? 8 : capacity;
+   while (newCapacity < n)
+      newCapacity *= 2;
+   resize(newCapacity);
+}
 
 /**~*~*
   Member function getCount returns
@@ -83,27 +178,30 @@ bool Queue<T>::isEmpty()
   the queue.
 *~**/
 template <class T>
-bool Queue<T>::enqueue(T item)
+bool Queue<T>::enqueue(const T &item)
 {
-   QueueNode *newNode; // Pointer to a new node
-
-   // Allocate a new node and store num there.
-   newNode = new QueueNode;
-   if (!newNode)
-       return false;
-   newNode->value = item;
-
-   // Update links and counter
-   newNode->next = NULL;
-
-   if( front == NULL )        // insert to an empty queue
-       front = newNode;
-   else
-       rear->next = newNode;
+   makeRoom();
+   new (buffer + slotAt(count)) T(item);
+   count++;
+   return true;
+}
 
+template <class T>
+bool Queue<T>::enqueue(T &&item)
+{
+   makeRoom();
+   new (buffer + slotAt(count)) T(std::move(item));
    count++;
-   rear = newNode;
+   return true;
+}
 
+template <class T>
+template <class... Args>
+bool Queue<T>::emplace(Args&&... args)
+{
+   makeRoom();
+   new (buffer + slotAt(count)) T(std::forward<Args>(args)...);
+   count++;
    return true;
 }
 
@@ -115,23 +213,15 @@ bool Queue<T>::enqueue(T item)
 template <class T>
 bool Queue<T>::dequeue(T &item)
 {
-    QueueNode *pDel; // Temporary pointer
-
     // empty queue
     if (count == 0)
        return false;
 
    // delete the value at the front of the queue
-    item = front->value;
-    pDel = front;
-
-    if( count == 1 )
-      rear = front = NULL;
-    else
-      front = front->next;
-
+    item = std::move(buffer[front]);
+    buffer[front].~T();
+    front = slotAt(1);
     count--;
-    delete pDel;
 
    return true;
 }
@@ -143,10 +233,10 @@ bool Queue<T>::dequeue(T &item)
 template <class T>
 bool Queue<T>::queueFront(T &item)
 {
-    if( front == NULL )
+    if( count == 0 )
         return false;
 
-    item = front->value;
+    item = buffer[front];
 
     return true;
 }
@@ -158,10 +248,10 @@ bool Queue<T>::queueFront(T &item)
 template <class T>
 bool Queue<T>::queueRear(T &item)
 {
-    if( rear == NULL )
+    if( count == 0 )
         return false;
 
-    item = rear->value;
+    item = buffer[slotAt(count - 1)];
     return true;
 }
 
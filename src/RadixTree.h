@@ -0,0 +1,369 @@
+// Radix tree (compressed trie) template
+// Maps string keys to items, with prefix completion
+// and bounded edit-distance (Levenshtein) search
+
+#ifndef _RADIX_TREE
+#define _RADIX_TREE
+#include <string>
+#include <vector>
+
+using std::string;
+
+template<class ItemType>
+class RadixTree
+{
+private:
+	// Structure for the tree nodes, children are kept as a
+	// sibling list sorted by the first character of their label
+	struct RadixNode
+	{
+		string label;           // Edge label leading into this node
+		ItemType item;          // Item stored for the key ending here
+		bool hasItem;           // True if a key ends at this node
+		RadixNode* child;       // First child
+		RadixNode* sibling;     // Next sibling
+
+		RadixNode(const string& l) { label = l; hasItem = false; child = 0; sibling = 0; }
+	};
+
+	RadixNode* root;    // Root node, always has an empty label
+	int count;          // Number of keys in the tree
+
+	// length of the common prefix of key (from pos) and label
+	static size_t commonPrefix(const string& key, size_t pos, const string& label);
+	// find the child whose label starts with c
+	static RadixNode* findChild(RadixNode* nodePtr, char c);
+	// link a new child in sorted position
+	static void addChild(RadixNode* parent, RadixNode* newChild);
+	// unlink a child from its parent
+	static void removeChild(RadixNode* parent, RadixNode* target);
+	// merge a node holding no item with its only child
+	static void mergeWithChild(RadixNode* nodePtr);
+	// delete the nodePtr subtree
+	void destroyTree(RadixNode* nodePtr);
+	// locate the node for an exact key
+	RadixNode* findNode(const string& key) const;
+
+	// internal traversals
+	template<class Output>
+	int _visitAll(RadixNode* nodePtr, void visit(ItemType&, Output&), Output& out, int limit) const;
+	template<class Output>
+	int _fuzzySearch(RadixNode* nodePtr, const string& key, const std::vector<int>& prevRow,
+		int maxDistance, void visit(ItemType&, Output&), Output& out) const;
+
+public:
+	RadixTree() { root = new RadixNode(""); count = 0; }
+	~RadixTree() { destroyTree(root); }
+	RadixTree(const RadixTree&) = delete;
+	RadixTree& operator=(const RadixTree&) = delete;
+
+	int size() const { return count; }
+	bool isEmpty() const { return count == 0; }
+	// insert an item with the key, return false if the key already exists
+	bool insert(const string& key, const ItemType& newItem);
+	// remove the item with the key
+	bool remove(const string& key);
+	// find the item with the exact key
+	bool getEntry(const string& key, ItemType& returnedItem) const;
+	// heap bytes held by the nodes and their labels
+	size_t memoryUsage() const;
+	// visit up to limit items whose key starts with prefix in key order (limit <= 0 for all),
+	// handing each to visit with an output of any type
+	template<class Output>
+	int prefixSearch(const string& prefix, void visit(ItemType&, Output&), Output& out, int limit) const;
+	// visit all items whose key is within maxDistance edits of key
+	template<class Output>
+	int fuzzySearch(const string& key, int maxDistance, void visit(ItemType&, Output&), Output& out) const;
+};
+
+///////////////////////// public function definitions ///////////////////////////
+
+template<class ItemType>
+bool RadixTree<ItemType>::insert(const string& key, const ItemType& newItem)
+{
+	RadixNode* nodePtr = root;
+	size_t pos = 0;
+
+	while (pos < key.size())
+	{
+		RadixNode* next = findChild(nodePtr, key[pos]);
+		if (next == 0)
+		{
+			// No edge shares a character, hang the rest of the key off this node
+			RadixNode* leaf = new RadixNode(key.substr(pos));
+			leaf->item = newItem;
+			leaf->hasItem = true;
+			addChild(nodePtr, leaf);
+			count++;
+			return true;
+		}
+
+		size_t common = commonPrefix(key, pos, next->label);
+		if (common < next->label.size())
+		{
+			// Split the edge: the shared part becomes a new middle node
+			RadixNode* middle = new RadixNode(next->label.substr(0, common));
+			removeChild(nodePtr, next);
+			next->label.erase(0, common);
+			addChild(middle, next);
+			addChild(nodePtr, middle);
+			next = middle;
+		}
+		nodePtr = next;
+		pos += common;
+	}
+
+	if (nodePtr->hasItem)
+		return false;
+	nodePtr->item = newItem;
+	nodePtr->hasItem = true;
+	count++;
+	return true;
+}
+
+template<class ItemType>
+bool RadixTree<ItemType>::remove(const string& key)
+{
+	RadixNode* parent = 0;
+	RadixNode* nodePtr = root;
+	size_t pos = 0;
+
+	while (pos < key.size())
+	{
+		RadixNode* next = findChild(nodePtr, key[pos]);
+		if (next == 0 || key.compare(pos, next->label.size(), next->label) != 0)
+			return false;
+		parent = nodePtr;
+		nodePtr = next;
+		pos += next->label.size();
+	}
+	if (!nodePtr->hasItem)
+		return false;
+
+	nodePtr->hasItem = false;
+	nodePtr->item = ItemType();
+	count--;
+
+	// Keep the tree compressed: drop empty leaves, merge pass-through nodes
+	if (nodePtr != root)
+	{
+		if (nodePtr->child == 0)
+		{
+			removeChild(parent, nodePtr);
+			delete nodePtr;
+			if (parent != root && !parent->hasItem && parent->child != 0 && parent->child->sibling == 0)
+				mergeWithChild(parent);
+		}
+		else if (nodePtr->child->sibling == 0)
+		{
+			mergeWithChild(nodePtr);
+		}
+	}
+	return true;
+}
+
+template<class ItemType>
+bool RadixTree<ItemType>::getEntry(const string& key, ItemType& returnedItem) const
+{
+	RadixNode* nodePtr = findNode(key);
+	if (nodePtr && nodePtr->hasItem)
+	{
+		returnedItem = nodePtr->item;
+		return true;
+	}
+	return false;
+}
+
+template<class ItemType>
+template<class Output>
+int RadixTree<ItemType>::prefixSearch(const string& prefix, void visit(ItemType&, Output&), Output& out, int limit) const
+{
+	RadixNode* nodePtr = root;
+	size_t pos = 0;
+
+	// Walk down until the prefix is used up, it may end inside an edge label
+	while (pos < prefix.size())
+	{
+		RadixNode* next = findChild(nodePtr, prefix[pos]);
+		if (next == 0)
+			return 0;
+		size_t common = commonPrefix(prefix, pos, next->label);
+		if (pos + common < prefix.size() && common < next->label.size())
+			return 0;
+		nodePtr = next;
+		pos += common;
+	}
+	return _visitAll(nodePtr, visit, out, limit);
+}
+
+template<class ItemType>
+template<class Output>
+int RadixTree<ItemType>::fuzzySearch(const string& key, int maxDistance, void visit(ItemType&, Output&), Output& out) const
+{
+	// Distance from the empty string to each prefix of key
+	std::vector<int> firstRow(key.size() + 1);
+	for (size_t i = 0; i <= key.size(); i++)
+		firstRow[i] = (int)i;
+	return _fuzzySearch(root, key, firstRow, maxDistance, visit, out);
+}
+
+template<class ItemType>
+size_t RadixTree<ItemType>::memoryUsage() const
+{
+	size_t bytes = 0;
+	std::vector<const RadixNode*> nodes(1, root);
+	while (!nodes.empty())
+	{
+		const RadixNode* nodePtr = nodes.back();
+		nodes.pop_back();
+		bytes += sizeof(RadixNode);
+		// labels short enough for the string's own buffer take no extra memory
+		if (nodePtr->label.capacity() > string().capacity())
+			bytes += nodePtr->label.capacity() + 1;
+		for (const RadixNode* pCur = nodePtr->child; pCur != 0; pCur = pCur->sibling)
+			nodes.push_back(pCur);
+	}
+	return bytes;
+}
+
+//////////////////////////// private functions ////////////////////////////////////////////
+
+template<class ItemType>
+size_t RadixTree<ItemType>::commonPrefix(const string& key, size_t pos, const string& label)
+{
+	size_t i = 0;
+	while (i < label.size() && pos + i < key.size() && key[pos + i] == label[i])
+		i++;
+	return i;
+}
+
+template<class ItemType>
+typename RadixTree<ItemType>::RadixNode* RadixTree<ItemType>::findChild(RadixNode* nodePtr, char c)
+{
+	for (RadixNode* pCur = nodePtr->child; pCur != 0; pCur = pCur->sibling)
+		if (pCur->label[0] == c)
+			return pCur;
+	return 0;
+}
+
+template<class ItemType>
+void RadixTree<ItemType>::addChild(RadixNode* parent, RadixNode* newChild)
+{
+	RadixNode** link = &parent->child;
+	while (*link != 0 && (unsigned char)(*link)->label[0] < (unsigned char)newChild->label[0])
+		link = &(*link)->sibling;
+	newChild->sibling = *link;
+	*link = newChild;
+}
+
+template<class ItemType>
+void RadixTree<ItemType>::removeChild(RadixNode* parent, RadixNode* target)
+{
+	RadixNode** link = &parent->child;
+	while (*link != target)
+		link = &(*link)->sibling;
+	*link = target->sibling;
+	target->sibling = 0;
+}
+
+template<class ItemType>
+void RadixTree<ItemType>::mergeWithChild(RadixNode* nodePtr)
+{
+	RadixNode* onlyChild = nodePtr->child;
+	nodePtr->label += onlyChild->label;
+	nodePtr->item = onlyChild->item;
+	nodePtr->hasItem = onlyChild->hasItem;
+	nodePtr->child = onlyChild->child;
+	delete onlyChild;
+}
+
+template<class ItemType>
+void RadixTree<ItemType>::destroyTree(RadixNode* nodePtr)
+{
+	while (nodePtr != 0)
+	{
+		RadixNode* next = nodePtr->sibling;
+		destroyTree(nodePtr->child);
+		delete nodePtr;
+		nodePtr = next;
+	}
+}
+
+template<class ItemType>
+typename RadixTree<ItemType>::RadixNode* RadixTree<ItemType>::findNode(const string& key) const
+{
+	RadixNode* nodePtr = root;
+	size_t pos = 0;
+	while (pos < key.size())
+	{
+		nodePtr = findChild(nodePtr, key[pos]);
+		if (nodePtr == 0 || key.compare(pos, nodePtr->label.size(), nodePtr->label) != 0)
+			return 0;
+		pos += nodePtr->label.size();
+	}
+	return nodePtr;
+}
+
+template<class ItemType>
+template<class Output>
+int RadixTree<ItemType>::_visitAll(RadixNode* nodePtr, void visit(ItemType&, Output&), Output& out, int limit) const
+{
+	int visited = 0;
+	if (nodePtr->hasItem)
+	{
+		ItemType item = nodePtr->item;
+		visit(item, out);
+		visited++;
+	}
+	for (RadixNode* pCur = nodePtr->child; pCur != 0; pCur = pCur->sibling)
+	{
+		if (limit > 0 && visited >= limit)
+			break;
+		visited += _visitAll(pCur, visit, out, limit > 0 ? limit - visited : 0);
+	}
+	return visited;
+}
+
+// Extends the edit-distance table by one row per label character and
+// prunes the subtree once every cell in the row exceeds maxDistance
+template<class ItemType>
+template<class Output>
+int RadixTree<ItemType>::_fuzzySearch(RadixNode* nodePtr, const string& key, const std::vector<int>& prevRow,
+	int maxDistance, void visit(ItemType&, Output&), Output& out) const
+{
+	std::vector<int> row(prevRow);
+	std::vector<int> lastRow(key.size() + 1);
+	int visited = 0;
+
+	for (size_t l = 0; l < nodePtr->label.size(); l++)
+	{
+		lastRow.swap(row);
+		row[0] = lastRow[0] + 1;
+		int rowMin = row[0];
+		for (size_t i = 1; i <= key.size(); i++)
+		{
+			int replaceCost = lastRow[i - 1] + (key[i - 1] == nodePtr->label[l] ? 0 : 1);
+			int insertCost = row[i - 1] + 1;
+			int deleteCost = lastRow[i] + 1;
+			row[i] = replaceCost < insertCost ? replaceCost : insertCost;
+			if (deleteCost < row[i])
+				row[i] = deleteCost;
+			if (row[i] < rowMin)
+				rowMin = row[i];
+		}
+		if (rowMin > maxDistance)
+			return 0;
+	}
+
+	if (nodePtr->hasItem && row[key.size()] <= maxDistance)
+	{
+		ItemType item = nodePtr->item;
+		visit(item, out);
+		visited++;
+	}
+	for (RadixNode* pCur = nodePtr->child; pCur != 0; pCur = pCur->sibling)
+		visited += _fuzzySearch(pCur, key, row, maxDistance, visit, out);
+	return visited;
+}
+
+#endif
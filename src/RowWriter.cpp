@@ -0,0 +1,148 @@
+// Implementation file for the RowWriter class
+
+#include "RowWriter.h"
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+	// Longest number to_chars writes for a long long or a double with 6 digits
+	const int NUMBER_LENGTH = 32;
+}
+
+//**************************************************
+// Constructor
+//**************************************************
+RowWriter::RowWriter(std::ostream& stream, size_t bufferSize)
+	: out(stream)
+{
+	capacity = bufferSize > (size_t)NUMBER_LENGTH ? bufferSize : NUMBER_LENGTH;
+	buffer = new char[capacity];
+	used = 0;
+}
+
+//**************************************************
+// Destructor
+//**************************************************
+RowWriter::~RowWriter()
+{
+	flush();
+	delete[] buffer;
+}
+
+//**************************************************
+// flush writes the buffer with one call
+//**************************************************
+void RowWriter::flush()
+{
+	if (used > 0)
+		out.write(buffer, used);
+	used = 0;
+}
+
+//**************************************************
+// reserve
+//**************************************************
+char* RowWriter::reserve(size_t n)
+{
+	if (used + n > capacity)
+		flush();
+	return buffer + used;
+}
+
+RowWriter& RowWriter::put(char c)
+{
+	*reserve(1) = c;
+	used++;
+	return *this;
+}
+
+//**************************************************
+// put copies the text, text longer than the whole
+// buffer is written straight to the stream
+//**************************************************
+RowWriter& RowWriter::put(const char* text, size_t length)
+{
+	if (length > capacity)
+	{
+		flush();
+		out.write(text, length);
+		return *this;
+	}
+	memcpy(reserve(length), text, length);
+	used += length;
+	return *this;
+}
+
+RowWriter& RowWriter::put(long long value)
+{
+	char* start = reserve(NUMBER_LENGTH);
+	used += std::to_chars(start, start + NUMBER_LENGTH, value).ptr - start;
+	return *this;
+}
+
+RowWriter& RowWriter::put(double value)
+{
+	char* start = reserve(NUMBER_LENGTH);
+	used += std::to_chars(start, start + NUMBER_LENGTH, value, std::chars_format::general, 6).ptr - start;
+	return *this;
+}
+
+RowWriter& RowWriter::putExact(double value)
+{
+	char* start = reserve(NUMBER_LENGTH);
+	used += std::to_chars(start, start + NUMBER_LENGTH, value).ptr - start;
+	return *this;
+}
+
+//**************************************************
+// left aligned fields
+//**************************************************
+RowWriter& RowWriter::left(const string& text, int width)
+{
+	put(text);
+	pad(text.size(), width);
+	return *this;
+}
+
+RowWriter& RowWriter::left(long long value, int width)
+{
+	// the number and its padding go in without a flush between them
+	size_t before;
+	reserve(NUMBER_LENGTH + (width > 0 ? width : 0));
+	before = used;
+	put(value);
+	pad(used - before, width);
+	return *this;
+}
+
+RowWriter& RowWriter::left(double value, int width)
+{
+	size_t before;
+	reserve(NUMBER_LENGTH + (width > 0 ? width : 0));
+	before = used;
+	put(value);
+	pad(used - before, width);
+	return *this;
+}
+
+RowWriter& RowWriter::fill(char c, int count)
+{
+	while (count > 0)
+	{
+		size_t chunk = (size_t)count < capacity ? (size_t)count : capacity;
+		memset(reserve(chunk), c, chunk);
+		used += chunk;
+		count -= (int)chunk;
+	}
+	return *this;
+}
+
+//**************************************************
+// pad
+//**************************************************
+void RowWriter::pad(size_t length, int width)
+{
+	if ((int)length < width)
+		fill(' ', width - (int)length);
+}
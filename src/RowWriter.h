@@ -0,0 +1,62 @@
+// Specification file for the RowWriter class
+// Formats text rows into one large buffer and hands the buffer to the
+// output stream in a single write, instead of formatting every field
+// through iostream manipulators. Numbers are written with to_chars.
+
+#ifndef ROW_WRITER_H
+#define ROW_WRITER_H
+#include <ostream>
+#include <string>
+#include <cstddef>
+#include <cstring>
+
+using std::string;
+
+class RowWriter
+{
+public:
+	static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+	explicit RowWriter(std::ostream& out, size_t capacity = DEFAULT_CAPACITY);
+	// the rest of the buffer is written out
+	~RowWriter();
+	RowWriter(const RowWriter&) = delete;
+	RowWriter& operator=(const RowWriter&) = delete;
+
+	RowWriter& put(char c);
+	RowWriter& put(const char* text, size_t length);
+	RowWriter& put(const char* text) { return put(text, strlen(text)); }
+	RowWriter& put(const string& text) { return put(text.data(), text.size()); }
+	RowWriter& put(long long value);
+	RowWriter& put(int value) { return put((long long)value); }
+	// like an ostream with its default settings: 6 significant digits,
+	// fixed or scientific notation, whichever is shorter
+	RowWriter& put(double value);
+	// the shortest text that reads back as the same double
+	RowWriter& putExact(double value);
+
+	// left aligned in a field of at least width characters, like setw
+	RowWriter& left(const string& text, int width);
+	RowWriter& left(long long value, int width);
+	RowWriter& left(int value, int width) { return left((long long)value, width); }
+	RowWriter& left(double value, int width);
+
+	RowWriter& fill(char c, int count);
+	RowWriter& newline() { return put('\n'); }
+
+	// hand the buffered text to the stream, it is not flushed
+	void flush();
+	size_t size() const { return used; }
+
+private:
+	std::ostream& out;
+	char* buffer;
+	size_t capacity;
+	size_t used;
+
+	// room for n more characters, flushing first if needed
+	char* reserve(size_t n);
+	// pad after length characters were written into a field of width
+	void pad(size_t length, int width);
+};
+#endif
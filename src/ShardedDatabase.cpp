@@ -0,0 +1,294 @@
+// Implementation file for the ShardedDatabase class
+
+#include "ShardedDatabase.h"
+#include <thread>
+#include <queue>
+#include <utility>
+
+//**************************************************
+// Constructor
+//**************************************************
+ShardedDatabase::ShardedDatabase(int shardCount, int expectedCoins)
+{
+	if (shardCount < 1)
+		shardCount = 1;
+	if (shardCount > MAX_SHARDS)
+		shardCount = MAX_SHARDS;
+	for (int i = 0; i < shardCount; i++)
+		shards.push_back(new Shard(expectedCoins / shardCount + 1));
+}
+
+//**************************************************
+// Destructor
+//**************************************************
+ShardedDatabase::~ShardedDatabase()
+{
+	for (Shard* shard : shards)
+	{
+		// the primary tree holds each coin once
+		shard->primary.inOrder(visitDelete);
+		delete shard;
+	}
+}
+
+ShardedDatabase::Shard::Shard(int capacity)
+{
+	// unsorted buckets that move found items to the front, like the single database
+	hash = new HashTable<CryptocurrencyPtr>(capacity, DList<CryptocurrencyPtr>::MOVE_TO_FRONT);
+}
+
+ShardedDatabase::Shard::~Shard()
+{
+	delete hash;
+}
+
+//**************************************************
+// shardOf uses the high bits of the name's hash,
+// the hash tables use the low bits for buckets
+//**************************************************
+int ShardedDatabase::shardOf(const string& name) const
+{
+	return (int)((hashKey(name) >> 32) % shards.size());
+}
+
+//**************************************************
+// size
+//**************************************************
+int ShardedDatabase::size()
+{
+	int total = 0;
+	for (size_t i = 0; i < shards.size(); i++)
+		total += getShardSize((int)i);
+	return total;
+}
+
+int ShardedDatabase::getShardSize(int shard)
+{
+	std::lock_guard<std::mutex> lock(shards[shard]->lock);
+	return shards[shard]->primary.size();
+}
+
+size_t ShardedDatabase::getShardMemory(int shard)
+{
+	Shard& s = *shards[shard];
+	std::lock_guard<std::mutex> lock(s.lock);
+	return s.primary.memoryUsage() + s.secondary.memoryUsage() + s.hash->memoryUsage();
+}
+
+//**************************************************
+// insert
+//**************************************************
+bool ShardedDatabase::insert(Cryptocurrency* crypto)
+{
+	Shard& shard = *shards[shardOf(crypto->getName())];
+	std::lock_guard<std::mutex> lock(shard.lock);
+	return insertInto(shard, crypto);
+}
+
+//**************************************************
+// insertMany splits the coins by shard first, so
+// each thread takes only the lock of its own shard
+//**************************************************
+int ShardedDatabase::insertMany(const vector<Cryptocurrency*>& coins)
+{
+	vector<vector<Cryptocurrency*> > parts(shards.size());
+	for (Cryptocurrency* crypto : coins)
+		parts[shardOf(crypto->getName())].push_back(crypto);
+
+	vector<int> inserted(shards.size(), 0);
+	vector<std::thread> threads;
+	for (size_t i = 0; i < shards.size(); i++)
+	{
+		threads.emplace_back([this, &parts, &inserted, i]()
+		{
+			Shard& shard = *shards[i];
+			std::lock_guard<std::mutex> lock(shard.lock);
+			shard.hash->reserve(shard.hash->getSize() + (int)parts[i].size());
+			for (Cryptocurrency* crypto : parts[i])
+			{
+				if (insertInto(shard, crypto))
+					inserted[i]++;
+				else
+					delete crypto;
+			}
+		});
+	}
+	int total = 0;
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+		total += inserted[i];
+	}
+	return total;
+}
+
+//**************************************************
+// insertInto
+//**************************************************
+bool ShardedDatabase::insertInto(Shard& shard, Cryptocurrency* crypto)
+{
+	const string& name = crypto->getName();
+	const string& alg = crypto->getAlg();
+	CryptocurrencyPtr found;
+	if (!FixedKey::fits(name) || !FixedKey::fits(alg))
+		return false;
+	if (shard.hash->findItem(name, found))
+		return false;
+	shard.primary.emplace(crypto, name);
+	shard.secondary.emplace(crypto, alg, name);
+	shard.hash->emplaceItem(crypto, name);
+	return true;
+}
+
+//**************************************************
+// remove; the secondary tree holds every coin with
+// the same algorithm under one key, so the entry to
+// remove is told apart by its name
+//**************************************************
+bool ShardedDatabase::remove(const string& name)
+{
+	Shard& shard = *shards[shardOf(name)];
+	std::lock_guard<std::mutex> lock(shard.lock);
+	CryptocurrencyPtr found;
+	if (!shard.hash->findItem(name, found))
+		return false;
+	Cryptocurrency* crypto = found.getCrypto();
+	shard.primary.remove(found);
+	shard.secondary.remove(CryptocurrencyPtr(nullptr, crypto->getAlg(), name));
+	shard.hash->deleteItem(name);
+	delete crypto;
+	return true;
+}
+
+//**************************************************
+// find
+//**************************************************
+bool ShardedDatabase::find(const string& name, Cryptocurrency& result)
+{
+	Shard& shard = *shards[shardOf(name)];
+	std::lock_guard<std::mutex> lock(shard.lock);
+	CryptocurrencyPtr found;
+	if (!shard.hash->findItem(name, found))
+		return false;
+	result = *found.getCrypto();
+	return true;
+}
+
+//**************************************************
+// findByAlg
+//**************************************************
+int ShardedDatabase::findByAlg(const string& alg, vector<Cryptocurrency>& results)
+{
+	CryptocurrencyPtr key(nullptr, alg);
+	scatter(true, &key, &key, results);
+	return (int)results.size();
+}
+
+//**************************************************
+// rangeByName
+//**************************************************
+int ShardedDatabase::rangeByName(const string& first, const string& last, vector<Cryptocurrency>& results, int limit)
+{
+	CryptocurrencyPtr low(nullptr, first), high(nullptr, last);
+	scatter(false, &low, &high, results, limit);
+	return (int)results.size();
+}
+
+//**************************************************
+// listByName and listByAlg
+//**************************************************
+void ShardedDatabase::listByName(vector<Cryptocurrency>& results)
+{
+	scatter(false, nullptr, nullptr, results);
+}
+
+void ShardedDatabase::listByAlg(vector<Cryptocurrency>& results)
+{
+	scatter(true, nullptr, nullptr, results);
+}
+
+//**************************************************
+// scatter locks the shards in index order, so two
+// scatters cannot each hold a lock the other needs
+//**************************************************
+void ShardedDatabase::scatter(bool byAlg, const CryptocurrencyPtr* low, const CryptocurrencyPtr* high, vector<Cryptocurrency>& results, int limit)
+{
+	vector<vector<CryptocurrencyPtr> > runs(shards.size());
+	vector<vector<Cryptocurrency> > rows(shards.size());
+	vector<std::unique_lock<std::mutex> > locks;
+	locks.reserve(shards.size());
+	for (Shard* shard : shards)
+		locks.emplace_back(shard->lock);
+	for (size_t i = 0; i < shards.size(); i++)
+	{
+		BinarySearchTree<CryptocurrencyPtr>& tree = byAlg ? shards[i]->secondary : shards[i]->primary;
+		if (low)
+			tree.rangeOutput(*low, *high, visitCollect, runs[i], limit);
+		else
+		{
+			runs[i].reserve(tree.size());
+			tree.inOrderOutput(visitCollect, runs[i]);
+		}
+		// a coin may be deleted as soon as its shard is unlocked
+		rows[i].reserve(runs[i].size());
+		for (const CryptocurrencyPtr& entry : runs[i])
+			rows[i].push_back(*entry.getCrypto());
+	}
+	// the entries hold their keys, they are merged without the locks
+	locks.clear();
+	merge(runs, rows, results, limit);
+}
+
+//**************************************************
+// merge keeps the head of every run in a heap and
+// takes the smallest, O(n log k) for k runs
+//**************************************************
+void ShardedDatabase::merge(const vector<vector<CryptocurrencyPtr> >& runs, vector<vector<Cryptocurrency> >& rows, vector<Cryptocurrency>& merged, int limit)
+{
+	// run and position of a head, the heap is ordered by the entry there
+	typedef std::pair<size_t, size_t> Head;
+	auto later = [&runs](const Head& a, const Head& b)
+	{
+		const CryptocurrencyPtr& x = runs[a.first][a.second];
+		const CryptocurrencyPtr& y = runs[b.first][b.second];
+		if (y < x)
+			return true;
+		if (x < y)
+			return false;
+		return a.first > b.first;
+	};
+	std::priority_queue<Head, vector<Head>, decltype(later)> heads(later);
+	size_t total = 0;
+	for (size_t i = 0; i < runs.size(); i++)
+	{
+		total += runs[i].size();
+		if (!runs[i].empty())
+			heads.push(Head(i, 0));
+	}
+
+	if (limit > 0 && total > (size_t)limit)
+		total = (size_t)limit;
+	merged.clear();
+	merged.reserve(total);
+	while (!heads.empty() && merged.size() < total)
+	{
+		Head head = heads.top();
+		heads.pop();
+		merged.push_back(std::move(rows[head.first][head.second]));
+		if (++head.second < runs[head.first].size())
+			heads.push(head);
+	}
+}
+
+//**************************************************
+// visitCollect and visitDelete
+//**************************************************
+void ShardedDatabase::visitCollect(CryptocurrencyPtr& entry, vector<CryptocurrencyPtr>& items)
+{
+	items.push_back(entry);
+}
+
+void ShardedDatabase::visitDelete(CryptocurrencyPtr& entry)
+{
+	delete entry.getCrypto();
+}
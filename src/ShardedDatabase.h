@@ -0,0 +1,94 @@
+// Specification file for the ShardedDatabase class
+// Splits the coins by the hash of their name into a number of shards.
+// Each shard has its own primary tree, secondary tree and hash table and
+// its own lock, so changes to coins of different shards do not wait for
+// each other. A lookup by name goes to the one shard holding the name;
+// searches by algorithm, ranges and listings go to every shard and the
+// sorted results of the shards are merged into one sorted list.
+// The database owns its coins. Lookups hand out copies of the coins
+// taken under the shard locks, so a coin removed by another thread
+// afterwards does not change what the caller holds.
+
+#ifndef SHARDED_DATABASE_H
+#define SHARDED_DATABASE_H
+#include "BinarySearchTree.h"
+#include "HashTable.h"
+#include "Crypto.h"
+#include <vector>
+#include <string>
+#include <mutex>
+
+using std::vector;
+using std::string;
+
+class ShardedDatabase
+{
+public:
+	static const int MAX_SHARDS = 64;
+
+	// shardCount is kept between 1 and MAX_SHARDS; the hash tables are
+	// sized so that expectedCoins fit without a rehash
+	ShardedDatabase(int shardCount, int expectedCoins);
+	// deletes the coins
+	~ShardedDatabase();
+	ShardedDatabase(const ShardedDatabase&) = delete;
+	ShardedDatabase& operator=(const ShardedDatabase&) = delete;
+
+	int getShardCount() const { return (int)shards.size(); }
+	// the shard holding name
+	int shardOf(const string& name) const;
+	int size();
+	int getShardSize(int shard);
+	// heap bytes held by the indexes of a shard
+	size_t getShardMemory(int shard);
+
+	// false if the name is taken or a key is too long, the caller keeps
+	// crypto then; otherwise the database owns it
+	bool insert(Cryptocurrency* crypto);
+	// insert many coins, each shard loaded by its own thread; the coins
+	// that were not inserted are deleted, returns the number inserted
+	int insertMany(const vector<Cryptocurrency*>& coins);
+	// remove and delete the coin, false if not found
+	bool remove(const string& name);
+
+	bool find(const string& name, Cryptocurrency& result);
+	// coins with algorithm alg, returns the number found
+	int findByAlg(const string& alg, vector<Cryptocurrency>& results);
+	// coins with names from first to last, both included, sorted by name;
+	// only the first limit of them when limit > 0
+	int rangeByName(const string& first, const string& last, vector<Cryptocurrency>& results, int limit = 0);
+	// every coin sorted by name
+	void listByName(vector<Cryptocurrency>& results);
+	// every coin sorted by algorithm; coins with the same algorithm are
+	// in the order of their shards, then in the order they were added
+	void listByAlg(vector<Cryptocurrency>& results);
+
+private:
+	struct Shard
+	{
+		std::mutex lock;
+		BinarySearchTree<CryptocurrencyPtr> primary;
+		BinarySearchTree<CryptocurrencyPtr> secondary;  // by algorithm, name as pk
+		HashTable<CryptocurrencyPtr>* hash;
+
+		explicit Shard(int capacity);
+		~Shard();
+	};
+
+	vector<Shard*> shards;
+
+	// insert into one shard, the caller holds its lock
+	static bool insertInto(Shard& shard, Cryptocurrency* crypto);
+	// the coins of every shard from low to high, or all of them when the
+	// bounds are nullptr, copied under all the locks so that they are one
+	// consistent view, then merged; with limit > 0 each shard gives and the
+	// result keeps only the first limit coins of the range
+	void scatter(bool byAlg, const CryptocurrencyPtr* low, const CryptocurrencyPtr* high, vector<Cryptocurrency>& results, int limit = 0);
+	// k-way merge of sorted runs of entries, equal entries in the order of
+	// the runs; rows[i][j] is the copy of the coin of runs[i][j] and is
+	// moved to merged
+	static void merge(const vector<vector<CryptocurrencyPtr> >& runs, vector<vector<Cryptocurrency> >& rows, vector<Cryptocurrency>& merged, int limit);
+	static void visitCollect(CryptocurrencyPtr& entry, vector<CryptocurrencyPtr>& items);
+	static void visitDelete(CryptocurrencyPtr& entry);
+};
+#endif
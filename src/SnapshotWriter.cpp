@@ -0,0 +1,160 @@
+// Implementation file for the SnapshotWriter class
+
+#include "SnapshotWriter.h"
+#include "RowWriter.h"
+#include <fstream>
+#include <chrono>
+
+//**************************************************
+// Constructor
+//**************************************************
+SnapshotWriter::SnapshotWriter()
+{
+	format = Exporter::TEXT;
+	last.count = 0;
+	last.written = false;
+	last.seconds = 0;
+	running = false;
+	done = false;
+	reported = true;
+}
+
+//**************************************************
+// Destructor
+//**************************************************
+SnapshotWriter::~SnapshotWriter()
+{
+	wait();
+}
+
+//**************************************************
+// load
+//**************************************************
+void SnapshotWriter::load(const vector<CryptocurrencyPtr>& sorted)
+{
+	wait();
+	coins.assignSorted(sorted);
+}
+
+//**************************************************
+// start
+//**************************************************
+void SnapshotWriter::start(Exporter::Format snapshotFormat, const string& fileName)
+{
+	wait();
+	version = coins.current();
+	format = snapshotFormat;
+	last.fileName = fileName;
+	last.count = 0;
+	last.written = false;
+	last.seconds = 0;
+	done = false;
+	reported = false;
+	running = true;
+	thread = std::thread(&SnapshotWriter::run, this);
+}
+
+//**************************************************
+// wait joins the thread and drops the saved coins
+//**************************************************
+void SnapshotWriter::wait()
+{
+	if (!running)
+		return;
+	thread.join();
+	running = false;
+	preserved.clear();
+}
+
+//**************************************************
+// preserve copies the coin once per snapshot
+//**************************************************
+void SnapshotWriter::preserve(const Cryptocurrency* crypto)
+{
+	if (!isRunning())
+		return;
+	std::lock_guard<std::mutex> lock(mutex);
+	if (preserved.count(crypto) == 0)
+		preserved.emplace(crypto, Cryptocurrency(crypto->getName(), crypto->getAlg(), crypto->getSupply(),
+			crypto->getDate(), crypto->getPrice(), crypto->getFounder()));
+}
+
+//**************************************************
+// memoryUsage; preserved only changes on the calling
+// thread, so it is read without the lock
+//**************************************************
+size_t SnapshotWriter::memoryUsage() const
+{
+	size_t bytes = coins.memoryUsage();
+	for (const std::pair<const Cryptocurrency* const, Cryptocurrency>& saved : preserved)
+		bytes += sizeof(saved) + sizeof(void*) + saved.second.getName().capacity() + saved.second.getAlg().capacity() + saved.second.getFounder().capacity();
+	return bytes + preserved.bucket_count() * sizeof(void*);
+}
+
+//**************************************************
+// takeResult
+//**************************************************
+bool SnapshotWriter::takeResult(Result& result)
+{
+	if (reported || (running && !done))
+		return false;
+	wait();
+	result = last;
+	reported = true;
+	return true;
+}
+
+//**************************************************
+// run is the thread; it holds the lock while it
+// reads a group of coins, so none of them can be
+// changed before it is either read or preserved
+//**************************************************
+void SnapshotWriter::run()
+{
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	// the version does not change, it is read without the lock
+	snapshot.clear();
+	snapshot.reserve(version.size());
+	version.inOrderOutput(visitList, snapshot);
+	version = PersistentBST<CryptocurrencyPtr>::Version();
+	std::ofstream file(last.fileName, std::ios::binary);
+	if (file)
+	{
+		{
+			RowWriter out(file);
+			Exporter* exporter = Exporter::create(format, out);
+			exporter->begin();
+			for (size_t start = 0; start < snapshot.size(); start += LOCK_ROWS)
+			{
+				size_t end = start + LOCK_ROWS < snapshot.size() ? start + LOCK_ROWS : snapshot.size();
+				std::lock_guard<std::mutex> lock(mutex);
+				for (size_t i = start; i < end; i++)
+				{
+					const Cryptocurrency* crypto = snapshot[i];
+					if (!preserved.empty())
+					{
+						std::unordered_map<const Cryptocurrency*, Cryptocurrency>::const_iterator saved = preserved.find(crypto);
+						if (saved != preserved.end())
+							crypto = &saved->second;
+					}
+					exporter->write(*crypto);
+				}
+			}
+			exporter->end();
+			last.count = exporter->getCount();
+			delete exporter;
+		}
+		file.close();
+		last.written = !file.fail();
+	}
+	last.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	done = true;
+}
+
+//**************************************************
+// visitList
+//**************************************************
+void SnapshotWriter::visitList(CryptocurrencyPtr& entry, vector<const Cryptocurrency*>& list)
+{
+	list.push_back(entry.getCrypto());
+}
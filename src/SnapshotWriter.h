@@ -0,0 +1,84 @@
+// Specification file for the SnapshotWriter class
+// Writes a snapshot of the database to a file on a background thread
+// while the commands go on changing the database. The writer keeps its
+// own persistent tree of the coins in name order, told about every coin
+// added or removed, so taking a snapshot is only taking its current
+// version. The coins are copied on write: before a coin of a running
+// snapshot is changed or deleted, its values are saved with preserve,
+// and the thread writes the saved values in its place. Price histories
+// are not part of a snapshot.
+
+#ifndef SNAPSHOT_WRITER_H
+#define SNAPSHOT_WRITER_H
+#include "Crypto.h"
+#include "Exporter.h"
+#include "PersistentBST.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+using std::vector;
+using std::string;
+
+class SnapshotWriter
+{
+public:
+	// How the last snapshot went
+	struct Result
+	{
+		string fileName;
+		int count;          // coins written
+		bool written;       // false if the file could not be opened or written
+		double seconds;     // time the thread took
+	};
+
+	// Rows the thread writes between two looks at the saved coins
+	static const int LOCK_ROWS = 256;
+
+	SnapshotWriter();
+	// waits for the running snapshot
+	~SnapshotWriter();
+	SnapshotWriter(const SnapshotWriter&) = delete;
+	SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+	// replace the coins with entries sorted by name
+	void load(const vector<CryptocurrencyPtr>& sorted);
+	// call after a coin is added to or removed from the database
+	void coinAdded(const CryptocurrencyPtr& entry) { coins.insert(entry); }
+	void coinRemoved(const string& name) { coins.remove(CryptocurrencyPtr(nullptr, name)); }
+	int getCoinCount() const { return coins.size(); }
+	// heap bytes of the tree of coins and the coins saved for the running snapshot
+	size_t memoryUsage() const;
+
+	// write the coins as they are now in format to fileName on the thread;
+	// a snapshot that is still running is waited for first
+	void start(Exporter::Format format, const string& fileName);
+	bool isRunning() const { return running && !done; }
+	void wait();
+	// true once for each finished snapshot, with how it went
+	bool takeResult(Result& result);
+
+	// call before crypto is changed or deleted; while a snapshot is being
+	// written the thread uses a copy of its current values instead
+	void preserve(const Cryptocurrency* crypto);
+
+private:
+	PersistentBST<CryptocurrencyPtr> coins;
+	PersistentBST<CryptocurrencyPtr>::Version version;   // of the running snapshot
+	vector<const Cryptocurrency*> snapshot;             // its coins, listed by the thread
+	std::unordered_map<const Cryptocurrency*, Cryptocurrency> preserved;
+	std::mutex mutex;           // guards preserved and the coins the thread reads
+	Exporter::Format format;
+	Result last;
+	bool running;               // a thread was started and not joined
+	std::atomic<bool> done;     // set by the thread when it is finished
+	bool reported;
+	std::thread thread;
+
+	void run();
+	static void visitList(CryptocurrencyPtr& entry, vector<const Cryptocurrency*>& list);
+};
+#endif
@@ -1,58 +1,145 @@
 /**~*~*
    Stack template
+   Values live in one growable array, so push and pop
+   do not allocate once the array is big enough
 *~**/
 #ifndef STACK_ADT_H
 #define STACK_ADT_H
 #include <iostream>
+#include <new>
+#include <utility>
 using namespace std;
 
 template <class T>
 class Stack
 {
 private:
-   // Structure for the stach nodes
-   struct StackNode
-   {
-      T value;          // Value in the node
-      StackNode *next;  // Pointer to next node
-   };
-
-   StackNode *top;     // Pointer to the stack top
-   int count;
+   T *buffer;        // capacity slots, the first count of them hold values
+   int capacity;
+   int count;        // also the slot above the top
+
+   // make room for one more value
+   void makeRoom();
+   // move the values into a new buffer of newCapacity slots
+   void resize(int newCapacity);
+   // destroy the values, keeping the buffer
+   void destroyValues();
+   // destroy the values and release the buffer
+   void release();
 
 public:
    //Constructor
-   Stack(){top = NULL; count = 0;}
+   Stack(){buffer = NULL; capacity = 0; count = 0;}
+   Stack(const Stack<T> &);
 
    // Destructor
-   ~Stack();
+   ~Stack() { release(); }
+
+   Stack<T> &operator=(const Stack<T> &);
 
    // Stack operations
    bool push(const T&);
+   bool push(T&&);
+   // build the value in place on top from its constructor arguments
+   template <class... Args>
+   bool emplace(Args&&... args);
    bool pop(T &);
    bool isEmpty();
    int getCount();
-   double getTop();
+   bool getTop(T &);
+   // make room for at least n values without reallocating
+   void reserve(int n);
 };
 
 /**~*~*
-   Destructor
+   Copy constructor
 *~**/
 template <class T>
-Stack<T>::~Stack()
+Stack<T>::Stack(const Stack<T> &other)
 {
-   StackNode *currNode, *nextNode;
+   buffer = NULL; capacity = 0; count = 0;
+   reserve(other.count);
+   for (int i = 0; i < other.count; i++)
+      push(other.buffer[i]);
+}
 
-   // Position nodePtr at the top of the stack.
-   currNode = top;
+/**~*~*
+   Assignment operator
+*~**/
+template <class T>
+Stack<T> &Stack<T>::operator=(const Stack<T> &other)
+{
+   if (this != &other)
+   {
+      destroyValues();
+      reserve(other.count);
+      for (int i = 0; i < other.count; i++)
+         push(other.buffer[i]);
+   }
+   return *this;
+}
 
-   // Traverse the list deleting each node.
-   while (currNode) //while (currNode != NULL)
+/**~*~*
+  Member function destroyValues empties the stack
+  in place.
+*~**/
+template <class T>
+void Stack<T>::destroyValues()
+{
+   for (int i = 0; i < count; i++)
+      buffer[i].~T();
+   count = 0;
+}
+
+/**~*~*
+  Member function release destroys the values
+  and frees the buffer.
+*~**/
+template <class T>
+void Stack<T>::release()
+{
+   destroyValues();
+   ::operator delete(buffer);
+   buffer = NULL;
+   capacity = 0;
+}
+
+/**~*~*
+  Member function resize moves the values
+  into a new buffer.
+*~**/
+template <class T>
+void Stack<T>::resize(int newCapacity)
+{
+   T *newBuffer = static_cast<T *>(::operator new(sizeof(T) * newCapacity));
+   for (int i = 0; i < count; i++)
    {
-      nextNode = currNode->next;
-      delete currNode;
-      currNode = nextNode;
+      new (newBuffer + i) T(std::move(buffer[i]));
+      buffer[i].~T();
    }
+   ::operator delete(buffer);
+   buffer = newBuffer;
+   capacity = newCapacity;
+}
+
+/**~*~*
+  Member function makeRoom doubles the buffer when it is full.
+*~**/
+template <class T>
+void Stack<T>::makeRoom()
+{
+   if (count == capacity)
+      resize(capacity == 0 ? 8 : capacity * 2);
+}
+
+/**~*~*
+  Member function reserve grows the buffer to hold n values.
+*~**/
+template <class T>
+void Stack<T>::reserve(int n)
+{
+   if (n > capacity)
+      resize(n);
 }
 
 /**~*~*
@@ -68,9 +155,12 @@ int Stack<T>::getCount()
   Member function grabs the top without changing the stack
 *~**/
 template <class T>
-double Stack<T>::getTop()
+bool Stack<T>::getTop(T &item)
 {
-	return top;
+   if (isEmpty())
+      return false;
+   item = buffer[count - 1];
+   return true;
 }
 
 /**~*~*
@@ -80,19 +170,28 @@ double Stack<T>::getTop()
 template <class T>
 bool Stack<T>::push(const T& item)
 {
-   StackNode *newNode; // Pointer to a new node
-
-   // Allocate a new node and store num there.
-   newNode = new StackNode;
-   if (!newNode)
-       return false;
-   newNode->value = item;
+   makeRoom();
+   new (buffer + count) T(item);
+   count++;
+   return true;
+}
 
-   // Update links and counter
-   newNode->next = top;
-   top = newNode;
+template <class T>
+bool Stack<T>::push(T&& item)
+{
+   makeRoom();
+   new (buffer + count) T(std::move(item));
    count++;
+   return true;
+}
 
+template <class T>
+template <class... Args>
+bool Stack<T>::emplace(Args&&... args)
+{
+   makeRoom();
+   new (buffer + count) T(std::forward<Args>(args)...);
+   count++;
    return true;
 }
 
@@ -104,18 +203,14 @@ bool Stack<T>::push(const T& item)
 template <class T>
 bool Stack<T>::pop(T &item)
 {
-   StackNode *temp; // Temporary pointer
-
    // empty stack
    if (count == 0)
        return false;
 
    // pop value off top of stack
-   item = top->value;
-   temp = top->next;
-   delete top;
-   top = temp;
    count--;
+   item = std::move(buffer[count]);
+   buffer[count].~T();
 
    return true;
 }
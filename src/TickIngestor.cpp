@@ -0,0 +1,266 @@
+// Implementation file for the TickIngestor class
+
+#include "TickIngestor.h"
+#include "Crypto.h"
+#include <charconv>
+#include <cstring>
+#include <cmath>
+
+//**************************************************
+// Constructor
+//**************************************************
+TickIngestor::TickIngestor(std::istream& in, long long windowLength, int ticksPerWindow, void normalizeName(string&))
+	: input(in)
+{
+	normalize = normalizeName;
+	window = windowLength;
+	maxTicks = ticksPerWindow > 0 ? ticksPerWindow : DEFAULT_MAX_TICKS;
+	buffer.resize(BLOCK_SIZE);
+	begin = end = 0;
+	inputDone = false;
+	pendingCount = 0;
+	slots.assign(64, -1);
+	windowStart = -1;
+	windowTicks = 0;
+	ticks = 0;
+	badLines = 0;
+}
+
+//**************************************************
+// nextBatch reads ticks into the open window until
+// a tick falls past its end, it holds maxTicks ticks
+// or the input ends
+//**************************************************
+bool TickIngestor::nextBatch(vector<Tick>& batch)
+{
+	const char* line;
+	const char* name;
+	size_t length, nameLength;
+	double price;
+	long long supply, timestamp;
+
+	while (nextLine(line, length))
+	{
+		if (length == 0)
+			continue;
+		if (!parseLine(line, length, name, nameLength, price, supply, timestamp))
+		{
+			badLines++;
+			continue;
+		}
+		ticks++;
+		// a tick past the window starts the next one
+		if (timestamp >= 0 && windowStart >= 0 && timestamp >= windowStart + window && pendingCount > 0)
+		{
+			closeWindow(batch);
+			coalesce(name, nameLength, price, supply, timestamp);
+			return true;
+		}
+		coalesce(name, nameLength, price, supply, timestamp);
+		if (windowTicks >= maxTicks)
+		{
+			closeWindow(batch);
+			return true;
+		}
+	}
+
+	if (pendingCount == 0)
+		return false;
+	closeWindow(batch);
+	return true;
+}
+
+//**************************************************
+// nextLine returns the next line without its end,
+// refilling the buffer a block at a time
+//**************************************************
+bool TickIngestor::nextLine(const char*& line, size_t& length)
+{
+	while (true)
+	{
+		const char* start = buffer.data() + begin;
+		const char* newline = (const char*)memchr(start, '\n', end - begin);
+		if (newline)
+		{
+			line = start;
+			length = newline - start;
+			begin += length + 1;
+			if (length > 0 && line[length - 1] == '\r')
+				length--;
+			return true;
+		}
+		if (inputDone)
+		{
+			// the last line may have no end
+			if (begin == end)
+				return false;
+			line = start;
+			length = end - begin;
+			begin = end;
+			return true;
+		}
+
+		// move the partial line to the front and read behind it
+		memmove(buffer.data(), start, end - begin);
+		end -= begin;
+		begin = 0;
+		if (end == buffer.size())
+			buffer.resize(buffer.size() * 2);
+		input.read(buffer.data() + end, buffer.size() - end);
+		size_t bytesRead = (size_t)input.gcount();
+		if (bytesRead == 0)
+			inputDone = true;
+		end += bytesRead;
+	}
+}
+
+//**************************************************
+// parseLine splits "name,price,supply[,timestamp]",
+// spaces around the fields are allowed
+//**************************************************
+bool TickIngestor::parseLine(const char* line, size_t length, const char*& name, size_t& nameLength,
+	double& price, long long& supply, long long& timestamp)
+{
+	const char* p = line;
+	const char* last = line + length;
+
+	auto skipSpaces = [&]() { while (p < last && (*p == ' ' || *p == '\t')) p++; };
+	// the next field must be followed by a comma, or the end if it is the last one
+	auto endField = [&](bool lastField)
+	{
+		skipSpaces();
+		if (p < last && *p == ',')
+		{
+			p++;
+			return !lastField;
+		}
+		return p == last;
+	};
+
+	skipSpaces();
+	name = p;
+	const char* comma = (const char*)memchr(p, ',', last - p);
+	if (!comma)
+		return false;
+	nameLength = comma - name;
+	while (nameLength > 0 && (name[nameLength - 1] == ' ' || name[nameLength - 1] == '\t'))
+		nameLength--;
+	if (nameLength == 0)
+		return false;
+	p = comma + 1;
+
+	skipSpaces();
+	std::from_chars_result result = std::from_chars(p, last, price);
+	// NaN fails every comparison, from_chars reads "nan" and "inf" too
+	if (result.ec != std::errc() || !(price >= 0) || !std::isfinite(price))
+		return false;
+	p = result.ptr;
+	if (!endField(false))
+		return false;
+
+	skipSpaces();
+	result = std::from_chars(p, last, supply);
+	if (result.ec != std::errc() || supply < 0)
+		return false;
+	p = result.ptr;
+	skipSpaces();
+	timestamp = -1;
+	if (p == last)
+		return true;
+	if (!endField(false))
+		return false;
+
+	skipSpaces();
+	result = std::from_chars(p, last, timestamp);
+	if (result.ec != std::errc() || timestamp < 0)
+		return false;
+	p = result.ptr;
+	return endField(true);
+}
+
+//**************************************************
+// coalesce overwrites the coin's tick in the open
+// window, or adds it if this is its first tick
+//**************************************************
+void TickIngestor::coalesce(const char* name, size_t nameLength, double price, long long supply, long long timestamp)
+{
+	if (normalize)
+	{
+		scratch.assign(name, nameLength);
+		normalize(scratch);
+		name = scratch.data();
+		nameLength = scratch.size();
+	}
+	unsigned long long hash = hashKey(name, nameLength);
+	size_t mask = slots.size() - 1;
+	size_t slot = (size_t)hash & mask;
+	while (slots[slot] != -1)
+	{
+		int index = slots[slot];
+		if (pendingHash[index] == hash && pending[index].name.compare(0, string::npos, name, nameLength) == 0)
+			break;
+		slot = (slot + 1) & mask;
+	}
+
+	int index = slots[slot];
+	if (index == -1)
+	{
+		index = pendingCount++;
+		slots[slot] = index;
+		// the strings of earlier windows are reused
+		if (index == (int)pending.size())
+		{
+			pending.emplace_back();
+			pendingHash.push_back(0);
+		}
+		pending[index].name.assign(name, nameLength);
+		pendingHash[index] = hash;
+		if (pendingCount * 2 > (int)slots.size())
+			growSlots();
+	}
+
+	Tick& tick = pending[index];
+	tick.price = price;
+	tick.supply = supply;
+	tick.timestamp = timestamp;
+	if (windowStart < 0 && timestamp >= 0)
+		windowStart = timestamp;
+	windowTicks++;
+}
+
+//**************************************************
+// growSlots doubles the slot table
+//**************************************************
+void TickIngestor::growSlots()
+{
+	slots.assign(slots.size() * 2, -1);
+	size_t mask = slots.size() - 1;
+	for (int i = 0; i < pendingCount; i++)
+	{
+		size_t slot = (size_t)pendingHash[i] & mask;
+		while (slots[slot] != -1)
+			slot = (slot + 1) & mask;
+		slots[slot] = i;
+	}
+}
+
+//**************************************************
+// closeWindow copies the coalesced ticks to batch
+// and empties the window, keeping its buffers
+//**************************************************
+void TickIngestor::closeWindow(vector<Tick>& batch)
+{
+	batch.resize(pendingCount);
+	for (int i = 0; i < pendingCount; i++)
+	{
+		batch[i].name.assign(pending[i].name);
+		batch[i].price = pending[i].price;
+		batch[i].supply = pending[i].supply;
+		batch[i].timestamp = pending[i].timestamp;
+	}
+	for (size_t slot = 0; slot < slots.size(); slot++)
+		slots[slot] = -1;
+	pendingCount = 0;
+	windowStart = -1;
+	windowTicks = 0;
+}
@@ -0,0 +1,86 @@
+// Specification file for the TickIngestor class
+// Reads a feed of price ticks, one "name,price,supply[,timestamp]" line
+// each, from a file or a named pipe, and hands them out in batches that
+// hold only the latest tick of each coin seen within a time window.
+// Input is read in large blocks and parsed in place with from_chars, and
+// the per-window buffers are reused, so a tick for a coin already seen
+// in the window costs no allocation. Names are normalized before the ticks
+// are coalesced, so two spellings of one coin count as one coin.
+
+#ifndef TICK_INGESTOR_H
+#define TICK_INGESTOR_H
+#include <istream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+class TickIngestor
+{
+public:
+	struct Tick
+	{
+		string name;
+		double price;
+		long long supply;
+		long long timestamp;     // milliseconds, -1 if the line had none
+	};
+
+	// Width of a window in timestamp units (milliseconds)
+	static const long long DEFAULT_WINDOW = 1000;
+	// Ticks per window when the feed has no timestamps
+	static const int DEFAULT_MAX_TICKS = 1 << 16;
+
+	// normalize, if given, turns a feed name into the name of its coin
+	TickIngestor(std::istream& input, long long window = DEFAULT_WINDOW, int maxTicks = DEFAULT_MAX_TICKS,
+		void normalize(string&) = nullptr);
+
+	// read until the window closes or the input ends, batch gets the
+	// latest tick of each coin in the window in order of first appearance;
+	// false once the input is exhausted and no tick was left
+	bool nextBatch(vector<Tick>& batch);
+
+	long long getTickCount() const { return ticks; }
+	long long getBadLineCount() const { return badLines; }
+
+private:
+	static const int BLOCK_SIZE = 1 << 16;
+
+	std::istream& input;
+	long long window;
+	int maxTicks;
+	void (*normalize)(string&);
+	string scratch;               // the name being normalized, reused
+
+	// Read buffer, the unparsed bytes are buffer[begin, end)
+	vector<char> buffer;
+	size_t begin;
+	size_t end;
+	bool inputDone;
+
+	// Coins of the open window: pending[0, pendingCount) in order of first
+	// appearance, found through an open addressing table of their indexes
+	vector<Tick> pending;
+	vector<unsigned long long> pendingHash;
+	int pendingCount;
+	vector<int> slots;            // -1 when free, the size is a power of two
+	long long windowStart;        // timestamp of the first tick, -1 if none yet
+	int windowTicks;              // ticks read into the open window
+
+	long long ticks;
+	long long badLines;
+
+	// the next complete line, false at the end of the input
+	bool nextLine(const char*& line, size_t& length);
+	// parse a line into its fields, false if it is malformed
+	static bool parseLine(const char* line, size_t length, const char*& name, size_t& nameLength,
+		double& price, long long& supply, long long& timestamp);
+	// keep the tick as the latest of its coin in the open window
+	void coalesce(const char* name, size_t nameLength, double price, long long supply, long long timestamp);
+	// double the slot table when it gets half full
+	void growSlots();
+	// move the open window to batch and start a new one
+	void closeWindow(vector<Tick>& batch);
+};
+#endif
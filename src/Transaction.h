@@ -0,0 +1,69 @@
+// Specification file for the Transaction class
+// Stages inserts, deletes and field updates so a batch of changes can be
+// checked as a whole and then applied to every index in one pass, or
+// dropped without touching the database. The transaction only holds the
+// changes: takeChanges ends it and hands them to the caller, which checks
+// and applies them (commitTransaction in main, which knows the indexes),
+// while rollback ends it and drops them.
+
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+#include <string>
+#include <vector>
+#include <utility>
+#include "Crypto.h"
+#include "UndoLog.h"
+
+using std::string;
+using std::vector;
+
+class Transaction
+{
+public:
+	// A staged change has the same shape as an undo log action
+	typedef UndoLog::Action Change;
+
+private:
+	vector<Change> changes;   // in the order they were staged
+	int inserts;              // how many of them are inserts
+	bool active;
+
+	bool stage(UndoLog::OpType type, const string& name, UndoLog::Field field, const Cryptocurrency& record)
+	{
+		if (!active)
+			return false;
+		changes.push_back(Change{ type, name, field, record });
+		if (type == UndoLog::OP_INSERT)
+			inserts++;
+		return true;
+	}
+
+public:
+	Transaction() { inserts = 0; active = false; }
+
+	// start staging, anything staged before is dropped
+	void begin() { changes.clear(); inserts = 0; active = true; }
+	bool isActive() const { return active; }
+
+	// stage a change, false if no transaction was begun
+	bool insert(const Cryptocurrency& crypto) { return stage(UndoLog::OP_INSERT, crypto.getName(), UndoLog::NAME, crypto); }
+	bool remove(const string& name) { return stage(UndoLog::OP_DELETE, name, UndoLog::NAME, Cryptocurrency()); }
+	// value holds the new content of field
+	bool update(const string& name, UndoLog::Field field, const Cryptocurrency& value) { return stage(UndoLog::OP_UPDATE, name, field, value); }
+
+	// drop the staged changes and end the transaction
+	void rollback() { changes.clear(); inserts = 0; active = false; }
+
+	// move the staged changes out for the caller to apply and end the transaction
+	vector<Change> takeChanges()
+	{
+		vector<Change> staged = std::move(changes);
+		rollback();
+		return staged;
+	}
+
+	int getCount() const { return (int)changes.size(); }
+	int getInsertCount() const { return inserts; }
+	const vector<Change>& getChanges() const { return changes; }
+};
+#endif
@@ -0,0 +1,315 @@
+// Implementation file for the UndoLog class
+
+#include "UndoLog.h"
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	template<class T>
+	void packNumber(string& data, T value)
+	{
+		data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<class T>
+	T unpackNumber(const string& data, size_t& pos)
+	{
+		T value;
+		memcpy(&value, data.data() + pos, sizeof(T));
+		pos += sizeof(T);
+		return value;
+	}
+}
+
+//**************************************************
+// Constructor
+//**************************************************
+UndoLog::UndoLog(size_t maxBytes)
+{
+	bytesUsed = 0;
+	byteLimit = maxBytes;
+	grouping = false;
+	groupStarted = false;
+}
+
+//**************************************************
+// recordInsert keeps the whole coin, so a redo can
+// create it again after the undo deleted it
+//**************************************************
+void UndoLog::recordInsert(const Cryptocurrency& crypto)
+{
+	Record rec;
+	rec.type = OP_INSERT;
+	rec.field = 0;
+	packRecord(rec.data, crypto);
+	push(std::move(rec));
+}
+
+//**************************************************
+// recordDelete keeps the whole coin for the undo
+//**************************************************
+void UndoLog::recordDelete(const Cryptocurrency& crypto)
+{
+	Record rec;
+	rec.type = OP_DELETE;
+	rec.field = 0;
+	packRecord(rec.data, crypto);
+	push(std::move(rec));
+}
+
+//**************************************************
+// recordUpdate keeps the name before the change and
+// the old and new value of the one field
+//**************************************************
+void UndoLog::recordUpdate(Field field, const Cryptocurrency& before, const Cryptocurrency& after)
+{
+	Record rec;
+	rec.type = OP_UPDATE;
+	rec.field = (unsigned char)field;
+	rec.data.append(before.getName());
+	rec.data.push_back('\0');
+	packField(rec.data, field, before);
+	packField(rec.data, field, after);
+	push(std::move(rec));
+}
+
+//**************************************************
+// beginGroup and endGroup
+//**************************************************
+void UndoLog::beginGroup()
+{
+	grouping = true;
+	groupStarted = false;
+}
+
+void UndoLog::endGroup()
+{
+	grouping = false;
+	enforceLimit();
+}
+
+//**************************************************
+// undo moves the records of the latest operation to
+// the redo list, latest first, so that redo finds
+// the first of them at the back
+//**************************************************
+bool UndoLog::undo(std::vector<Action>& actions)
+{
+	actions.clear();
+	bool joined = true;
+	while (joined && !undoRecords.empty())
+	{
+		Record& rec = undoRecords.back();
+		joined = rec.joined;
+		actions.emplace_back();
+		decode(rec, true, actions.back());
+		redoRecords.push_back(std::move(rec));
+		undoRecords.pop_back();
+	}
+	return !actions.empty();
+}
+
+//**************************************************
+// redo moves the latest undone operation back, in
+// the order it was first applied
+//**************************************************
+bool UndoLog::redo(std::vector<Action>& actions)
+{
+	actions.clear();
+	do
+	{
+		if (redoRecords.empty())
+			break;
+		actions.emplace_back();
+		decode(redoRecords.back(), false, actions.back());
+		undoRecords.push_back(std::move(redoRecords.back()));
+		redoRecords.pop_back();
+	} while (!redoRecords.empty() && redoRecords.back().joined);
+	return !actions.empty();
+}
+
+//**************************************************
+// setLimit
+//**************************************************
+void UndoLog::setLimit(size_t maxBytes)
+{
+	byteLimit = maxBytes;
+	enforceLimit();
+}
+
+//**************************************************
+// clear drops every record
+//**************************************************
+void UndoLog::clear()
+{
+	groupStarted = false;
+	undoRecords.clear();
+	redoRecords.clear();
+	bytesUsed = 0;
+}
+
+//**************************************************
+// copyField
+//**************************************************
+void UndoLog::copyField(Field field, const Cryptocurrency& source, Cryptocurrency& target)
+{
+	switch (field)
+	{
+	case NAME:    target.setName(source.getName()); break;
+	case ALG:     target.setAlg(source.getAlg()); break;
+	case SUPPLY:  target.setSupply(source.getSupply()); break;
+	case DATE:    target.setDate(source.getDate()); break;
+	case PRICE:   target.setPrice(source.getPrice()); break;
+	case FOUNDER: target.setFounder(source.getFounder()); break;
+	}
+}
+
+//**************************************************
+// push adds a new operation; anything undone before
+// it can no longer be redone
+//**************************************************
+void UndoLog::push(Record&& rec)
+{
+	dropRedo();
+	rec.joined = grouping && groupStarted;
+	groupStarted = grouping;
+	rec.data.shrink_to_fit();
+	bytesUsed += recordSize(rec);
+	undoRecords.push_back(std::move(rec));
+	// a group is only dropped whole, once it is complete
+	if (!grouping)
+		enforceLimit();
+}
+
+//**************************************************
+// dropRedo
+//**************************************************
+void UndoLog::dropRedo()
+{
+	for (const Record& rec : redoRecords)
+		bytesUsed -= recordSize(rec);
+	redoRecords.clear();
+}
+
+//**************************************************
+// enforceLimit forgets the oldest operations first,
+// with every record of each; the redo list goes
+// before any undo record
+//**************************************************
+void UndoLog::enforceLimit()
+{
+	if (bytesUsed > byteLimit)
+		dropRedo();
+	while (bytesUsed > byteLimit && !undoRecords.empty())
+	{
+		do
+		{
+			bytesUsed -= recordSize(undoRecords.front());
+			undoRecords.pop_front();
+		} while (!undoRecords.empty() && undoRecords.front().joined);
+	}
+}
+
+//**************************************************
+// packRecord: name, alg, founder, supply, date, price
+//**************************************************
+void UndoLog::packRecord(string& data, const Cryptocurrency& crypto)
+{
+	data.append(crypto.getName());
+	data.push_back('\0');
+	data.append(crypto.getAlg());
+	data.push_back('\0');
+	data.append(crypto.getFounder());
+	data.push_back('\0');
+	packNumber(data, crypto.getSupply());
+	packNumber(data, crypto.getDate());
+	packNumber(data, crypto.getPrice());
+}
+
+//**************************************************
+// unpackRecord
+//**************************************************
+void UndoLog::unpackRecord(const string& data, size_t& pos, Cryptocurrency& crypto)
+{
+	crypto.setName(unpackString(data, pos));
+	crypto.setAlg(unpackString(data, pos));
+	crypto.setFounder(unpackString(data, pos));
+	crypto.setSupply(unpackNumber<long long>(data, pos));
+	crypto.setDate(unpackNumber<int>(data, pos));
+	crypto.setPrice(unpackNumber<double>(data, pos));
+}
+
+//**************************************************
+// packField
+//**************************************************
+void UndoLog::packField(string& data, Field field, const Cryptocurrency& crypto)
+{
+	switch (field)
+	{
+	case NAME:    data.append(crypto.getName()); data.push_back('\0'); break;
+	case ALG:     data.append(crypto.getAlg()); data.push_back('\0'); break;
+	case FOUNDER: data.append(crypto.getFounder()); data.push_back('\0'); break;
+	case SUPPLY:  packNumber(data, crypto.getSupply()); break;
+	case DATE:    packNumber(data, crypto.getDate()); break;
+	case PRICE:   packNumber(data, crypto.getPrice()); break;
+	}
+}
+
+//**************************************************
+// unpackField
+//**************************************************
+void UndoLog::unpackField(const string& data, size_t& pos, Field field, Cryptocurrency& crypto)
+{
+	switch (field)
+	{
+	case NAME:    crypto.setName(unpackString(data, pos)); break;
+	case ALG:     crypto.setAlg(unpackString(data, pos)); break;
+	case FOUNDER: crypto.setFounder(unpackString(data, pos)); break;
+	case SUPPLY:  crypto.setSupply(unpackNumber<long long>(data, pos)); break;
+	case DATE:    crypto.setDate(unpackNumber<int>(data, pos)); break;
+	case PRICE:   crypto.setPrice(unpackNumber<double>(data, pos)); break;
+	}
+}
+
+//**************************************************
+// unpackString reads up to the next '\0'
+//**************************************************
+string UndoLog::unpackString(const string& data, size_t& pos)
+{
+	size_t end = data.find('\0', pos);
+	string result = data.substr(pos, end - pos);
+	pos = end + 1;
+	return result;
+}
+
+//**************************************************
+// decode turns a record into the action that redoes
+// it, or with reverse set, the action that undoes it
+//**************************************************
+void UndoLog::decode(const Record& rec, bool reverse, Action& action)
+{
+	size_t pos = 0;
+	action.field = (Field)rec.field;
+	if (rec.type == OP_UPDATE)
+	{
+		Cryptocurrency oldValue, newValue;
+		action.type = OP_UPDATE;
+		action.name = unpackString(rec.data, pos);
+		unpackField(rec.data, pos, action.field, oldValue);
+		unpackField(rec.data, pos, action.field, newValue);
+		// a renamed coin is found under its new name when undoing
+		if (reverse && action.field == NAME)
+			action.name = newValue.getName();
+		copyField(action.field, reverse ? oldValue : newValue, action.record);
+		return;
+	}
+
+	unpackRecord(rec.data, pos, action.record);
+	action.name = action.record.getName();
+	// undoing an insert deletes, undoing a delete inserts
+	if ((rec.type == OP_INSERT) != reverse)
+		action.type = OP_INSERT;
+	else
+		action.type = OP_DELETE;
+}
@@ -0,0 +1,102 @@
+// Specification file for the UndoLog class
+// Multi-level undo/redo of inserts, deletes and field updates.
+// Records are packed into byte strings holding only what the operation
+// needs (a whole record for inserts and deletes, one field's old and new
+// value for updates), and the oldest records are dropped to stay under a
+// memory limit. The records logged between beginGroup and endGroup are one
+// operation: they are undone, redone and dropped together.
+
+#ifndef UNDO_LOG_H
+#define UNDO_LOG_H
+#include <deque>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "Crypto.h"
+
+using std::string;
+
+class UndoLog
+{
+public:
+	enum OpType { OP_INSERT, OP_DELETE, OP_UPDATE };
+	// fields an OP_UPDATE record can change
+	enum Field { NAME, ALG, SUPPLY, DATE, PRICE, FOUNDER };
+
+	// An operation to apply to the database, decoded from a record
+	struct Action
+	{
+		OpType type;
+		string name;             // key of the coin it targets (OP_DELETE, OP_UPDATE)
+		Field field;             // OP_UPDATE only
+		Cryptocurrency record;   // OP_INSERT: the coin to create, OP_UPDATE: holds the new field value
+	};
+
+	// Default memory limit for the records
+	static const size_t DEFAULT_LIMIT = 1 << 20;
+
+	UndoLog(size_t maxBytes = DEFAULT_LIMIT);
+
+	// log an operation that was just applied, the redo list is dropped
+	void recordInsert(const Cryptocurrency& crypto);
+	void recordDelete(const Cryptocurrency& crypto);
+	// before and after are the coin around a change of field
+	void recordUpdate(Field field, const Cryptocurrency& before, const Cryptocurrency& after);
+
+	// log the operations recorded until endGroup as one; the limit is
+	// enforced at endGroup, a group larger than the limit is dropped whole
+	void beginGroup();
+	void endGroup();
+
+	// the actions reverting the latest operation, in the order to apply
+	// them, false if there is none
+	bool undo(std::vector<Action>& actions);
+	// the actions repeating the latest undone operation, false if there is none
+	bool redo(std::vector<Action>& actions);
+
+	int getUndoCount() const { return (int)undoRecords.size(); }
+	int getRedoCount() const { return (int)redoRecords.size(); }
+	// heap bytes held by the records
+	size_t memoryUsage() const { return bytesUsed; }
+	size_t getLimit() const { return byteLimit; }
+	// change the memory limit, dropping the oldest records if needed
+	void setLimit(size_t maxBytes);
+	void clear();
+
+	// copy one field from source to target
+	static void copyField(Field field, const Cryptocurrency& source, Cryptocurrency& target);
+
+private:
+	// One logged operation
+	struct Record
+	{
+		unsigned char type;     // OpType
+		unsigned char field;    // Field, OP_UPDATE only
+		bool joined;            // part of the same operation as the record logged before it
+		string data;            // packed values, see the pack functions
+	};
+
+	std::deque<Record> undoRecords;   // oldest at the front
+	std::deque<Record> redoRecords;   // next to redo at the back
+	size_t bytesUsed;
+	size_t byteLimit;
+	bool grouping;              // between beginGroup and endGroup
+	bool groupStarted;          // a record of the group was logged
+
+	static size_t recordSize(const Record& rec) { return sizeof(Record) + rec.data.capacity(); }
+	// add to the undo list and enforce the limit
+	void push(Record&& rec);
+	void dropRedo();
+	void enforceLimit();
+
+	// packing: strings end in '\0', numbers are raw bytes
+	static void packRecord(string& data, const Cryptocurrency& crypto);
+	static void unpackRecord(const string& data, size_t& pos, Cryptocurrency& crypto);
+	static void packField(string& data, Field field, const Cryptocurrency& crypto);
+	static void unpackField(const string& data, size_t& pos, Field field, Cryptocurrency& crypto);
+	static string unpackString(const string& data, size_t& pos);
+
+	// the action a record stands for, reversed when undoing it
+	static void decode(const Record& rec, bool reverse, Action& action);
+};
+#endif
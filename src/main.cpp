@@ -4,18 +4,45 @@
 #include "BinarySearchTree.h" 
 #include "Crypto.h"
 #include "HashTable.h"
-#include "StackADT.h"
+#include "RadixTree.h"
+#include "UndoLog.h"
+#include "Transaction.h"
+#include "TickIngestor.h"
+#include "RowWriter.h"
+#include "Exporter.h"
+#include "BackgroundWriter.h"
+#include "SnapshotWriter.h"
+#include "ShardedDatabase.h"
+#include "QueryServer.h"
+#include "QueryCache.h"
 #include <iostream>
 #include <string>
-#include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <chrono>
+#include <cstdlib>
 
 using namespace std;
 
-const string MAIN_COMMANDS = "ABCDEFGHI";
-const string SEARCH_COMMANDS = "ABCDE";
-const string LIST_COMMANDS = "ABCDEFG";
+const string MAIN_COMMANDS = "ABCDEFGHIJKLMN";
+const string SEARCH_COMMANDS = "ABCDEFGHI";
+const string LIST_COMMANDS = "ABCDEFGH";
 const string NOT_FOUND = "Cryptocurrency Not Found!";
+// Most edits allowed between a search key and a name in approximate search
+const int FUZZY_DISTANCE = 2;
+// Bytes the undo log may hold before it forgets the oldest operations
+const size_t UNDO_LOG_LIMIT = 1 << 20;
+// Price ticks whose timestamps fall in the same window (ms) are applied together
+const long long TICK_WINDOW = 1000;
+// Export format letters, in the order of Exporter::Format
+const string EXPORT_FORMATS = "CJBT";
+// Commands of the sharded database, the last one exits
+const string SHARD_COMMANDS = "ABCDEFGHIJ";
+// Shards of the database a server runs unless told otherwise
+const int SERVER_SHARDS = 4;
 
 // Menu printing function
 void displayMenu();
@@ -23,16 +50,26 @@ void displaytSearchSubMenu();
 void displaytListSubMenu();
 
 // Build tree function
-void buildTree(string filename, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr);
+void buildTree(string filename, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex);
+Cryptocurrency* readCrypto(istream& inFile);
 
 // Manager Functions
-void insertManager(BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr);
-void deleteManager(Stack<Cryptocurrency*>* deleteStack, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr);
-void searchManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr);
+void insertManager(UndoLog* undoLog, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+void deleteManager(UndoLog* undoLog, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+void updateManager(UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+void batchFileManager(UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+void tickFeedManager(HashTable<CryptocurrencyPtr>* hashArr, SnapshotWriter* snapshotWriter);
+void searchManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, QueryCache* queryCache);
 void primaryKeySearchManager(BinarySearchTree<CryptocurrencyPtr>* tree, void printCrypto(CryptocurrencyPtr&));
-void secondaryKeySearchManager(BinarySearchTree<CryptocurrencyPtr>* tree, void printCrypto(CryptocurrencyPtr&));
+void secondaryKeySearchManager(BinarySearchTree<CryptocurrencyPtr>* tree, QueryCache* queryCache, void printCrypto(CryptocurrencyPtr&, RowWriter&));
 void hashTableSearchManager(HashTable<CryptocurrencyPtr>* table, void printCrypto(CryptocurrencyPtr&));
-void listManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr);
+void prefixSearchManager(RadixTree<CryptocurrencyPtr>* nameIndex, void printCrypto(CryptocurrencyPtr&, RowWriter&));
+void fuzzySearchManager(RadixTree<CryptocurrencyPtr>* nameIndex, void printCrypto(CryptocurrencyPtr&, RowWriter&));
+void batchSearchManager(HashTable<CryptocurrencyPtr>* table, void printCrypto(CryptocurrencyPtr&, RowWriter&));
+void historySearchManager(HashTable<CryptocurrencyPtr>* table);
+void listManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, QueryCache* queryCache);
+void pageManager(BinarySearchTree<CryptocurrencyPtr>* tree, QueryCache* queryCache, void printCrypto(CryptocurrencyPtr&, RowWriter&));
+void printSortedList(BinarySearchTree<CryptocurrencyPtr>* tree, QueryCache* queryCache, QueryCache::Kind kind);
 
 // Main Search Function
 template<class T>
@@ -43,11 +80,16 @@ bool treeSearch(BinarySearchTree<CryptocurrencyPtr>* tree, string key, Cryptocur
 bool hashTableSearch(HashTable<CryptocurrencyPtr>* table, string key, CryptocurrencyPtr& result);
 
 // Screen Output function
-void printCrypto(Cryptocurrency& crypto);
+// A listing formats its rows into one RowWriter and writes them out at the end
+void printCrypto(Cryptocurrency& crypto, RowWriter& row);
+void printCrypto(CryptocurrencyPtr& cryptoPtr, RowWriter& row);
 void printCrypto(CryptocurrencyPtr& cryptoPtr);
-void visitIndented(int level, CryptocurrencyPtr& cryptoPtr);
+void visitIndented(int level, CryptocurrencyPtr& cryptoPtr, RowWriter& row);
+void printHeader(RowWriter& row);
 void printHeader();
+void printBucket(int bucket, RowWriter& row);
 void printHashTableStats(HashTable<CryptocurrencyPtr>* hashArr);
+void printMemoryStats(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, UndoLog* undoLog, QueryCache* queryCache, SnapshotWriter* snapshotWriter);
 string divider(int len, char symbol);
 
 // Input Function
@@ -60,63 +102,145 @@ void runCommand(char& runCommand,
 	BinarySearchTree<CryptocurrencyPtr>* primaryTree,
 	BinarySearchTree<CryptocurrencyPtr>* secondaryTree,
 	HashTable<CryptocurrencyPtr>* hashArr,
-	Stack<Cryptocurrency*>* deleteStack);
+	RadixTree<CryptocurrencyPtr>* nameIndex,
+	UndoLog* undoLog,
+	SnapshotWriter* snapshotWriter,
+	QueryCache* queryCache);
 
 void runSearchCommand(char& runCommand,
 	BinarySearchTree<CryptocurrencyPtr>* primaryTree,
 	BinarySearchTree<CryptocurrencyPtr>* secondaryTree,
-	HashTable<CryptocurrencyPtr>* hashArr);
+	HashTable<CryptocurrencyPtr>* hashArr,
+	RadixTree<CryptocurrencyPtr>* nameIndex,
+	QueryCache* queryCache);
 
 void runListCommand(char& runCommand,
 	BinarySearchTree<CryptocurrencyPtr>* primaryTree,
 	BinarySearchTree<CryptocurrencyPtr>* secondaryTree,
-	HashTable<CryptocurrencyPtr>* hashArr);
+	HashTable<CryptocurrencyPtr>* hashArr,
+	QueryCache* queryCache);
 
 // Validation Function
 bool yearValidator(int& year);
 bool supplyValidator(long long& supply);
 bool priceValidator(double& price);
+bool positiveValidator(int& num);
 bool validateInput(char& command, const string& COMMANDS);
 bool isAllAlpha(string& s);
 void normalizeStr(string& str);
+string foldCase(const string& str);
 
 // Trivial Functions
 bool isKeyExists(string& key, BinarySearchTree<CryptocurrencyPtr>* tree);
-bool insertAll(Cryptocurrency& crypto, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr);
+bool isNameTaken(const string& name, RadixTree<CryptocurrencyPtr>* nameIndex);
+bool insertAll(Cryptocurrency& crypto, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
 int getNumberOfLines(string filename);
-void undo(Stack<Cryptocurrency*>* undoStack, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr);
-void clearStack(Stack<Cryptocurrency*>* undoStack);
+Cryptocurrency* removeAll(const string& name, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+bool updateAll(const string& name, UndoLog::Field field, const Cryptocurrency& value, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+bool applyAction(const UndoLog::Action& action, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+string describeAction(const UndoLog::Action& action);
+bool stageChange(const string& line, Transaction& transaction);
+bool parseFieldValue(const string& fieldName, const string& text, UndoLog::Field& field, Cryptocurrency& value);
+template<typename T> bool parseValue(const string& text, T& value);
+bool commitTransaction(Transaction& transaction, UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+int applyTicks(const vector<TickIngestor::Tick>& batch, HashTable<CryptocurrencyPtr>* hashArr, SnapshotWriter* snapshotWriter, int& stale);
+void undo(UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+void redo(UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache);
+void deleteCrypto(CryptocurrencyPtr& cryptoPtr);
 void trimSpaces(string& line);
-void exit(Stack<Cryptocurrency*>* undoStack, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr);
+void exit(UndoLog* undoLog, SnapshotWriter* snapshotWriter, QueryCache* queryCache, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex);
 void printWelcome();
+Cryptocurrency* readCryptoDetails(const string& name, const string& alg);
 
 // Build to File Functions
-void writeData(BinarySearchTree <CryptocurrencyPtr>* primaryTree, string outFileName, Stack<Cryptocurrency*>* undoStack);
-void visitPrint(CryptocurrencyPtr& a, ofstream& outFile);
-
-
-
-int main()
+void writeData(BinarySearchTree <CryptocurrencyPtr>* primaryTree, string outFileName);
+void snapshotData(SnapshotWriter* snapshotWriter, const string& outFileName);
+void visitCollect(CryptocurrencyPtr& a, vector<CryptocurrencyPtr>& items);
+void reportSnapshot(SnapshotWriter* snapshotWriter);
+void exportManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree);
+bool exportData(BinarySearchTree<CryptocurrencyPtr>* primaryTree, Exporter::Format format, const string& fileName, bool background);
+int exportTo(BinarySearchTree<CryptocurrencyPtr>* primaryTree, Exporter::Format format, ostream& stream);
+void visitExport(CryptocurrencyPtr& a, Exporter& exporter);
+
+// Sharded database
+int shardedMain(const string& inputFileName, int shardCount);
+void runShardCommand(char& command, ShardedDatabase* database);
+void displayShardMenu();
+void loadShards(const string& filename, ShardedDatabase* database);
+void shardInsertManager(ShardedDatabase* database);
+void shardDeleteManager(ShardedDatabase* database);
+void shardNameSearchManager(ShardedDatabase* database);
+void shardAlgSearchManager(ShardedDatabase* database);
+void shardRangeManager(ShardedDatabase* database);
+void printCryptos(vector<Cryptocurrency>& cryptos);
+void printShardStats(ShardedDatabase* database);
+void writeShardData(ShardedDatabase* database, const string& outFileName);
+int serverMain(const string& inputFileName, const string& socketPath, int shardCount);
+
+
+
+int main(int argc, char* argv[])
 {
 	printWelcome();
 	string inputFileName = "CryptoList.txt";
+	string socketPath;
+	int shardCount = 0;
+	// "--shards N" splits the database into N shards instead,
+	// "--server PATH" serves it on a Unix socket instead of the menu
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		string option = argv[i];
+		if (option == "--shards")
+		{
+			if (!parseValue(string(argv[i + 1]), shardCount) || shardCount < 1 || shardCount > ShardedDatabase::MAX_SHARDS)
+			{
+				cout << "The number of shards must be from 1 to " << ShardedDatabase::MAX_SHARDS << ", not \"" << argv[i + 1] << "\"" << endl;
+				return EXIT_FAILURE;
+			}
+		}
+		else if (option == "--server")
+			socketPath = argv[i + 1];
+	}
+	if (!socketPath.empty())
+		return serverMain(inputFileName, socketPath, shardCount > 0 ? shardCount : SERVER_SHARDS);
+	if (shardCount > 0)
+		return shardedMain(inputFileName, shardCount);
 	int lines = getNumberOfLines(inputFileName);
 
-	Stack<Cryptocurrency*>* undoStack = new Stack<Cryptocurrency*>();
+	UndoLog* undoLog = new UndoLog(UNDO_LOG_LIMIT);
 
 	BinarySearchTree <CryptocurrencyPtr>* primaryTree = new BinarySearchTree <CryptocurrencyPtr>;
 	BinarySearchTree <CryptocurrencyPtr>* secondaryTree = new BinarySearchTree <CryptocurrencyPtr>;
 
-	HashTable<CryptocurrencyPtr>* hashArr = new HashTable<CryptocurrencyPtr>(lines); //Initialize the hashTable
-	buildTree(inputFileName, primaryTree, secondaryTree, hashArr);
+	// Unsorted buckets that move found items to the front, so hot coins are found first
+	HashTable<CryptocurrencyPtr>* hashArr = new HashTable<CryptocurrencyPtr>(lines, DList<CryptocurrencyPtr>::MOVE_TO_FRONT); //Initialize the hashTable
+	RadixTree<CryptocurrencyPtr>* nameIndex = new RadixTree<CryptocurrencyPtr>;
+	// Filter out lookups of coins that are not in the database
+	primaryTree->enableFilter();
+	hashArr->enableFilter();
+	buildTree(inputFileName, primaryTree, secondaryTree, hashArr, nameIndex);
+	// The database is mostly read after loading, search the trees as flat
+	// arrays; a single change thaws them and a batch freezes them again
+	primaryTree->freeze();
+	secondaryTree->freeze();
+	// Writes the sorted output file while the commands go on, from its own
+	// persistent copy of the primary tree
+	SnapshotWriter* snapshotWriter = new SnapshotWriter;
+	vector<CryptocurrencyPtr> sorted;
+	sorted.reserve(primaryTree->size());
+	primaryTree->inOrderOutput(visitCollect, sorted);
+	snapshotWriter->load(sorted);
+	// Keeps the results of repeated listings and algorithm searches
+	QueryCache* queryCache = new QueryCache;
 
 	displayMenu();
 
 	char command;
 	do
 	{
+		reportSnapshot(snapshotWriter);
 		if (getInput(command, MAIN_COMMANDS))
-			runCommand(command, primaryTree, secondaryTree, hashArr, undoStack);
+			runCommand(command, primaryTree, secondaryTree, hashArr, nameIndex, undoLog, snapshotWriter, queryCache);
 
 	} while (command != MAIN_COMMANDS[MAIN_COMMANDS.length() - 1]);
 	cout << "Bye! Thanks for using the Cryptocurrency Database!" << endl;
@@ -169,44 +293,71 @@ void runCommand(char& runCommand,
 	BinarySearchTree<CryptocurrencyPtr>* primaryTree,
 	BinarySearchTree<CryptocurrencyPtr>* secondaryTree,
 	HashTable<CryptocurrencyPtr>* hashArr,
-	Stack<Cryptocurrency*>* deleteStack)
+	RadixTree<CryptocurrencyPtr>* nameIndex,
+	UndoLog* undoLog,
+	SnapshotWriter* snapshotWriter,
+	QueryCache* queryCache)
 {
 	switch (runCommand)
 	{
 	case 'A':
-		insertManager(primaryTree, secondaryTree, hashArr);
+		insertManager(undoLog, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
 		break;
 	case 'B':
-		deleteManager(deleteStack, primaryTree, secondaryTree, hashArr);
+		deleteManager(undoLog, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
 		break;
 	case 'C':
-		searchManager(primaryTree, secondaryTree, hashArr);
+		searchManager(primaryTree, secondaryTree, hashArr, nameIndex, queryCache);
 		// Display the main menu after exit from the search manager
 		displayMenu();
 		break;
 	case 'D':
-		listManager(primaryTree, secondaryTree, hashArr);
+		listManager(primaryTree, secondaryTree, hashArr, queryCache);
 		displayMenu();
 		// Display the main menu after exit from the search manager
 		break;
 	case 'E':
-		writeData(primaryTree, "SortedOutput.txt", deleteStack);
-		// Write to file
+		// Write to file in the background
+		snapshotData(snapshotWriter, "SortedOutput.txt");
 		break;
 	case 'F':
 		// Show statistics
 		printHashTableStats(hashArr);
+		printMemoryStats(primaryTree, secondaryTree, hashArr, nameIndex, undoLog, queryCache, snapshotWriter);
 		break;
 	case 'G':
-		// Undo delete
-		undo(deleteStack, primaryTree, secondaryTree, hashArr);
+		// Undo the last change
+		undo(undoLog, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
 		break;
 	case 'H':
-		displayMenu();
+		// Redo the last undone change
+		redo(undoLog, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
 		break;
 	case 'I':
-		writeData(primaryTree, "SortedOutput.txt", deleteStack);
-		exit(deleteStack, primaryTree, secondaryTree, hashArr);
+		// Apply a file of changes as one transaction
+		batchFileManager(undoLog, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+		break;
+	case 'J':
+		// Change one field of a cryptocurrency
+		updateManager(undoLog, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+		break;
+	case 'K':
+		// Apply a feed of price ticks
+		tickFeedManager(hashArr, snapshotWriter);
+		break;
+	case 'L':
+		// Export in a machine-readable format
+		exportManager(primaryTree);
+		break;
+	case 'M':
+		displayMenu();
+		break;
+	case 'N':
+		// A snapshot still being written would race with the final file
+		snapshotWriter->wait();
+		reportSnapshot(snapshotWriter);
+		writeData(primaryTree, "SortedOutput.txt");
+		exit(undoLog, snapshotWriter, queryCache, primaryTree, secondaryTree, hashArr, nameIndex);
 		break;
 	}
 }
@@ -217,7 +368,6 @@ void runCommand(char& runCommand,
 
 void displayMenu()
 {
-	// add a undo delete
 	cout << "Welcome to our Cryptocurrency Database! Please select one of the following commands!" << endl;
 	cout << "" << endl;
 	cout << "A - Add new a Cryptocurrency " << endl;
@@ -226,9 +376,14 @@ void displayMenu()
 	cout << "D - Show Lists sub-menu" << endl;
 	cout << "E - Write the Cryptocurrencies to a file" << endl;
 	cout << "F - See the statistics" << endl;
-	cout << "G - Undo Delete" << endl;
-	cout << "H - Help to show the menu" << endl;
-	cout << "I - Exit" << endl;
+	cout << "G - Undo the last change" << endl;
+	cout << "H - Redo the last undone change" << endl;
+	cout << "I - Apply a batch file of changes" << endl;
+	cout << "J - Update a Cryptocurrency" << endl;
+	cout << "K - Apply a feed of price ticks" << endl;
+	cout << "L - Export the Cryptocurrencies (CSV, NDJSON or columnar binary)" << endl;
+	cout << "M - Help to show the menu" << endl;
+	cout << "N - Exit" << endl;
 	cout << endl;
 }
 
@@ -242,8 +397,12 @@ void displaytSearchSubMenu()
 	cout << "A - Search for a Cryptocurrency with Primary Key in BST" << endl;
 	cout << "B - Search for a Cryptocurrency with Secondary Key in BST" << endl;
 	cout << "C - Search for a Cryptocurrency with Primary Key in Hash Table" << endl;
-	cout << "D - Help to show the menu" << endl;
-	cout << "E - Exit" << endl;
+	cout << "D - Search for Cryptocurrencies by the beginning of the name" << endl;
+	cout << "E - Search for Cryptocurrencies with a similar name" << endl;
+	cout << "F - Search for many Cryptocurrencies at once in Hash Table" << endl;
+	cout << "G - Show the price history of a Cryptocurrency" << endl;
+	cout << "H - Help to show the menu" << endl;
+	cout << "I - Exit" << endl;
 	cout << endl;
 }
 
@@ -258,8 +417,9 @@ void displaytListSubMenu()
 	cout << "B - List data sorted by the primary key (name of the cryptocurrency)" << endl;
 	cout << "C - List data sorted by the secondary key (algorithm of the cryptocurrency)" << endl;
 	cout << "D - Special Print" << endl;
-	cout << "F - Help to show the menu" << endl;
-	cout << "G - Exit" << endl;
+	cout << "F - List one page of data sorted by the primary key" << endl;
+	cout << "G - Help to show the menu" << endl;
+	cout << "H - Exit" << endl;
 	cout << endl;
 }
 
@@ -267,19 +427,26 @@ void displaytListSubMenu()
 /* 
 	insert the cryptocurrenty to primaryTree, secondaryTree and hash table
 */
-bool insertAll(Cryptocurrency& crypto, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr)
+bool insertAll(Cryptocurrency& crypto, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
 	string name = crypto.getName();
 	string alg = crypto.getAlg();
-	// return false is the key already exists in primary tree
-	if (isKeyExists(name, primaryTree))
+	// return false if a key is too long to be stored inline
+	if (!FixedKey::fits(name) || !FixedKey::fits(alg))
 		return false;
-	CryptocurrencyPtr* nameAsKey = new CryptocurrencyPtr(&crypto, name);
+	// return false if the name is taken in any case; the name index is
+	// keyed on the folded name and holds one coin per key, so it goes first
+	if (!nameIndex->insert(foldCase(name), CryptocurrencyPtr(&crypto, name)))
+		return false;
+	// The wrappers are built in place inside each index, which owns its copy
+	primaryTree->emplace(&crypto, name);
 	// Insert with alg as secondary key and name as primary key
-	CryptocurrencyPtr* algAsKey = new CryptocurrencyPtr(&crypto, alg, name);
-	primaryTree->insert(*nameAsKey);
-	secondaryTree->insert(*algAsKey);
-	hashArr->insertItem(name, nameAsKey);
+	secondaryTree->emplace(&crypto, alg, name);
+	hashArr->emplaceItem(&crypto, name);
+	if (snapshotWriter)
+		snapshotWriter->coinAdded(CryptocurrencyPtr(&crypto, name));
+	if (queryCache)
+		queryCache->coinChanged(alg);
 	return true;
 }
 
@@ -313,14 +480,10 @@ int getNumberOfLines(string filename)
 	Builds a Binary Search Tree from a text file.
 */
 
-void buildTree(string filename, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr)
+void buildTree(string filename, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex)
 {
 
 	ifstream inFile;
-	string algor, founder, name;
-	long long supply;
-	int year;
-	double price;
 	Cryptocurrency* crypto;
 
 	inFile.open(filename);
@@ -330,42 +493,67 @@ void buildTree(string filename, BinarySearchTree<CryptocurrencyPtr>* primaryTree
 		exit(EXIT_FAILURE);
 	}
 
-	while (inFile >> algor >> supply >> founder >> year >> price)
+	while ((crypto = readCrypto(inFile)) != nullptr)
 	{
-		// To ignore the space after price
-		inFile.ignore();
-		getline(inFile, name);
-		//cout << algor << " " << supply << " " << founder << " " << year << " " << price << " " << name << endl;
-		crypto = new Cryptocurrency(name, algor, supply, year, price, founder);
-		insertAll(*crypto, primaryTree, secondaryTree, hashArr);
+		// The snapshot index is built in one pass once the file is loaded
+		if (!insertAll(*crypto, primaryTree, secondaryTree, hashArr, nameIndex, nullptr, nullptr))
+		{
+			cout << "Skipping \"" << crypto->getName() << "\": duplicate or too long name or algorithm" << endl;
+			delete crypto;
+		}
 	}
 	inFile.close();
 }
 
 /*
-	print infomations of the cryptocurrnecy in given format
+	read the next cryptocurrency of the list file, nullptr at the end
 */
-void printCrypto(Cryptocurrency& crypto)
+Cryptocurrency* readCrypto(istream& inFile)
 {
-	// Subject to change
-	cout << left;
-	cout << setw(24) << crypto.getName();
-	cout << setw(15) << crypto.getAlg();
-	cout << setw(6) << crypto.getDate();
-	cout << setw(12) << crypto.getFounder();
-	cout << "$" << setw(8) << crypto.getPrice();
-	cout << setw(12) << crypto.getSupply() << "||" << endl;
+	string algor, founder, name;
+	long long supply;
+	int year;
+	double price;
 
+	if (!(inFile >> algor >> supply >> founder >> year >> price))
+		return nullptr;
+	// To ignore the space after price
+	inFile.ignore();
+	getline(inFile, name);
+	//cout << algor << " " << supply << " " << founder << " " << year << " " << price << " " << name << endl;
+	return new Cryptocurrency(name, algor, supply, year, price, founder);
+}
+
+/*
+	print infomations of the cryptocurrnecy in given format
+*/
+void printCrypto(Cryptocurrency& crypto, RowWriter& row)
+{
+	row.left(crypto.getName(), 24);
+	row.left(crypto.getAlg(), 15);
+	row.left(crypto.getDate(), 6);
+	row.left(crypto.getFounder(), 12);
+	row.put('$').left(crypto.getPrice(), 8);
+	row.left(crypto.getSupply(), 12).put("||\n");
 }
 
 /*
 	overloaded function for printting CryptocurrencyPtr
 	print infomations of the cryptocurrnecy in given format
 */
-void printCrypto(CryptocurrencyPtr& cryptoPtr)
+void printCrypto(CryptocurrencyPtr& cryptoPtr, RowWriter& row)
 {
 	// Dereferencing the CryptocurrencyPtr then call the regular printCrypto function
-	printCrypto(*(cryptoPtr.crypto));
+	printCrypto(*(cryptoPtr.crypto), row);
+}
+
+/*
+	print a single cryptocurrency, written out in one call without a flush
+*/
+void printCrypto(CryptocurrencyPtr& cryptoPtr)
+{
+	RowWriter row(cout, 256);
+	printCrypto(cryptoPtr, row);
 }
 
 /*
@@ -373,26 +561,36 @@ void printCrypto(CryptocurrencyPtr& cryptoPtr)
 */
 string divider(int len, char symbol)
 {
-	string t = "";
-	for (int i = 0; i < len; i++)
-		t += symbol;
-	return t;
+	return string(len, symbol);
 }
 
 /*
 	print the header for the printCrypto function
 */
+void printHeader(RowWriter& header)
+{
+	header.newline().fill('=', 80).newline();
+	header.left("Name", 24);
+	header.left("Algorithm", 15);
+	header.left("Date", 6);
+	header.left("Founder", 12);
+	header.left("Price", 9);
+	header.left("Supply", 12).newline();
+	header.fill('=', 80).newline();
+}
+
 void printHeader()
 {
-	cout << endl << divider(80, '=') << endl;
-	cout << left;
-	cout << setw(24) << "Name";
-	cout << setw(15) << "Algorithm";
-	cout << setw(6) << "Date";
-	cout << setw(12) << "Founder";
-	cout << setw(9) << "Price";
-	cout << setw(12) << "Supply" << endl;
-	cout << divider(80, '=') << endl;
+	RowWriter header(cout, 256);
+	printHeader(header);
+}
+
+/*
+	print the line with the number of a hash table bucket
+*/
+void printBucket(int bucket, RowWriter& row)
+{
+	row.fill('-', 40).put(bucket).fill('-', 37).newline();
 }
 
 /*
@@ -403,6 +601,12 @@ void trimSpaces(string& line)
 	const string whiteSpaces = " \t\v\r\n";
 	size_t start = line.find_first_not_of(whiteSpaces);
 	size_t end = line.find_last_not_of(whiteSpaces);
+	// nothing but spaces
+	if (start == string::npos)
+	{
+		line = "";
+		return;
+	}
 	line = line.substr(start, end - start + 1);
 }
 
@@ -459,6 +663,14 @@ bool priceValidator(double& price)
 	return (price >= 0);
 }
 
+/*
+	validate page numbers and page sizes
+*/
+bool positiveValidator(int& num)
+{
+	return (num > 0);
+}
+
 /*
 	chekc if the key is exists in the BST
 */
@@ -469,24 +681,35 @@ bool isKeyExists(string& key, BinarySearchTree<CryptocurrencyPtr>* tree)
 
 }
 
+/*
+	check if a coin has the name in any case, the names differing
+	only in case would share one key in the name index
+*/
+bool isNameTaken(const string& name, RadixTree<CryptocurrencyPtr>* nameIndex)
+{
+	CryptocurrencyPtr tmp;
+	return nameIndex->getEntry(foldCase(name), tmp);
+}
+
 /*
 	handle taking inputs and inerst the the trees and hash table.
 */
-void insertManager(BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr)
+void insertManager(UndoLog* undoLog, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
 	Cryptocurrency* crypto;
-	CryptocurrencyPtr tmp;
-	int checker = 0;
-	string name, alg, founder;
-	long long supply;
-	int year;
-	double price;
+	string name, alg;
 
 	cout << "What is the name of the Cryptocurrency?" << endl;
 	getline(cin, name);
 	normalizeStr(name);
+
+	if (!FixedKey::fits(name))
+	{
+		cout << "The name can be at most " << FixedKey::CAPACITY << " characters long!" << endl;
+		return;
+	}
 	
-	if (isKeyExists(name, primaryTree))
+	if (isNameTaken(name, nameIndex))
 	{
 		cout << "The Cryptocurrency " + name + " already exists in the primary tree!" << endl;
 		return;
@@ -497,6 +720,32 @@ void insertManager(BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySear
 	getline(cin, alg);
 	trimSpaces(alg);
 
+	if (!FixedKey::fits(alg))
+	{
+		cout << "The algorithm can be at most " << FixedKey::CAPACITY << " characters long!" << endl;
+		return;
+	}
+
+	crypto = readCryptoDetails(name, alg);
+	insertAll(*crypto, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+	undoLog->recordInsert(*crypto);
+
+	cout << "The Cryptocurrency " + name + " has been inserted!" << endl;
+	cout << endl;
+
+}
+
+/*
+	prompt for the year, supply, price and founder of a new
+	cryptocurrency and build it
+*/
+Cryptocurrency* readCryptoDetails(const string& name, const string& alg)
+{
+	string founder;
+	long long supply;
+	int year;
+	double price;
+
 	while (!getInsertData(year, "What year was " + name + " founded?", yearValidator))
 	{
 		cout << "Please enter a valid year." << endl;
@@ -517,42 +766,26 @@ void insertManager(BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySear
 	getline(cin, founder);
 	normalizeStr(founder);
 
-	crypto = new Cryptocurrency(name, alg, supply, year, price, founder);
-	insertAll(*crypto, primaryTree, secondaryTree, hashArr);
-
-	cout << "The Cryptocurrency " + name + " has been inserted!" << endl;
-	cout << endl;
-
-	// for testing purposes
-	// cout << name << " " << alg << " " << supply << " " << year << " " << price << " " << founder << endl;
-
+	return new Cryptocurrency(name, alg, supply, year, price, founder);
 }
 
 /*
 	handling deletion and taking input from user
-	push deleted item to undo stack
+	log the deleted item for undo
 	and remove the item from hash table, and two trees
 */
-void deleteManager(Stack<Cryptocurrency*>* undoStack, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr)
+void deleteManager(UndoLog* undoLog, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
-	CryptocurrencyPtr cryptoPtr;
-	CryptocurrencyPtr tmp;
-	string name, alg;
+	string name;
 	cout << "Enter the name of the Cryptocurrency you wish to delete" << endl;
 	getline(cin, name);
 	trimSpaces(name);
-	// Check if cryptocurreny exists in the primary tree
-	if (treeSearch(primaryTree, name, cryptoPtr))
-	{
-		// Push to undo stack
-		undoStack->push(cryptoPtr.getCrypto());
-		alg = cryptoPtr.getCrypto()->getAlg();
-		// Remove the node form primary tree name as key
-		primaryTree->remove(CryptocurrencyPtr(nullptr, name));
-		// Remove the node form secondary tree with algorithm as key and name as primary key
-		secondaryTree->remove(CryptocurrencyPtr(nullptr, alg, name));
-		// Remove the node form secondary tree with name
-		hashArr->deleteItem(name);
+	Cryptocurrency* crypto = removeAll(name, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+	if (crypto)
+	{
+		// The log keeps a packed copy of the fields, not the object
+		undoLog->recordDelete(*crypto);
+		delete crypto;
 		cout << name << " has been deleted from both trees and the hash table" << endl;
 	}
 	else
@@ -562,215 +795,1000 @@ void deleteManager(Stack<Cryptocurrency*>* undoStack, BinarySearchTree <Cryptocu
 }
 
 /*
-	search in BST, return ture if found, else false
+	remove the cryptocurrency from the trees, hash table and name index,
+	return it for the caller to delete, or nullptr if not found
 */
-bool treeSearch(BinarySearchTree<CryptocurrencyPtr>* tree, string key, CryptocurrencyPtr& result)
+Cryptocurrency* removeAll(const string& name, BinarySearchTree <CryptocurrencyPtr>* primaryTree, BinarySearchTree <CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
-	if (tree->getEntry(CryptocurrencyPtr(nullptr, key), result))
-		return true;
-	else
-		return false;
+	CryptocurrencyPtr cryptoPtr;
+	// Check if cryptocurreny exists in the primary tree
+	if (!treeSearch(primaryTree, name, cryptoPtr))
+		return nullptr;
+	Cryptocurrency* crypto = cryptoPtr.getCrypto();
+	// The caller may change or delete the coin
+	if (snapshotWriter)
+		snapshotWriter->preserve(crypto);
+	// Remove the node form primary tree name as key
+	primaryTree->remove(CryptocurrencyPtr(nullptr, name));
+	// Remove the node form secondary tree with algorithm as key and name as primary key
+	secondaryTree->remove(CryptocurrencyPtr(nullptr, crypto->getAlg(), name));
+	// Remove the node form secondary tree with name
+	hashArr->deleteItem(name);
+	// Remove the name from the name index
+	nameIndex->remove(foldCase(name));
+	if (snapshotWriter)
+		snapshotWriter->coinRemoved(name);
+	if (queryCache)
+		queryCache->coinChanged(crypto->getAlg());
+	return crypto;
 }
 
 /*
-	search in hash table, return ture if found, else false
+	set one field of a cryptocurrency from value and keep the others,
+	only the indexes keyed on that field are touched: price, supply, year
+	and founder are changed in place through the hash table, a new
+	algorithm moves the coin in the secondary tree only, and a new name
+	indexes it again everywhere. Return false if the coin is not found,
+	or the new name is taken or a new key is too long
 */
-bool hashTableSearch(HashTable<CryptocurrencyPtr>* table, string key, CryptocurrencyPtr& result)
+bool updateAll(const string& name, UndoLog::Field field, const Cryptocurrency& value, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
-	if (table->findItem(key, result))
-		return true;
-	else
+	CryptocurrencyPtr cryptoPtr;
+	if (!hashTableSearch(hashArr, name, cryptoPtr))
 		return false;
+	Cryptocurrency* crypto = cryptoPtr.getCrypto();
+	string newKey;
+	if (snapshotWriter)
+		snapshotWriter->preserve(crypto);
+	switch (field)
+	{
+	case UndoLog::NAME:
+		newKey = value.getName();
+		// a change of case only keeps the coin's own key in the name index
+		if (!FixedKey::fits(newKey) || (foldCase(newKey) != foldCase(name) && isNameTaken(newKey, nameIndex)))
+			return false;
+		removeAll(name, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+		crypto->setName(newKey);
+		insertAll(*crypto, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+		break;
+	case UndoLog::ALG:
+		newKey = value.getAlg();
+		if (!FixedKey::fits(newKey))
+			return false;
+		secondaryTree->remove(CryptocurrencyPtr(nullptr, crypto->getAlg(), crypto->getName()));
+		if (queryCache)
+			queryCache->coinChanged(crypto->getAlg());
+		crypto->setAlg(newKey);
+		secondaryTree->emplace(crypto, newKey, crypto->getName());
+		if (queryCache)
+			queryCache->coinChanged(newKey);
+		break;
+	default:
+		// The indexes only point at the coin, nothing to move
+		UndoLog::copyField(field, value, *crypto);
+		break;
+	}
+	return true;
 }
 
 /*
-	handling calling function with corresponding command
+	handling update and taking input from user
+	log the old and new value for undo
 */
-void runSearchCommand(char& runCommand,
-	BinarySearchTree<CryptocurrencyPtr>* primaryTree,
-	BinarySearchTree<CryptocurrencyPtr>* secondaryTree,
-	HashTable<CryptocurrencyPtr>* hashArr)
+void updateManager(UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
-	switch (runCommand)
+	CryptocurrencyPtr cryptoPtr;
+	Cryptocurrency value;
+	UndoLog::Field field;
+	string name, fieldName, text;
+	cout << "Enter the name of the Cryptocurrency you wish to update" << endl;
+	getline(cin, name);
+	trimSpaces(name);
+	if (!hashTableSearch(hashArr, name, cryptoPtr))
 	{
-	case 'A':
-		primaryKeySearchManager(primaryTree, printCrypto);
-		cout << divider(80, '=') << endl << endl;
-		break;
-	case 'B':
-		secondaryKeySearchManager(secondaryTree, printCrypto);
-		cout << divider(80, '=') << endl << endl;
-		break;
-	case 'C':
-		hashTableSearchManager(hashArr, printCrypto);
-		cout << divider(80, '=') << endl << endl;
-		break;
-	case 'D':
-		displaytSearchSubMenu();
-		break;
-	case 'E':
-		cout << "Exiting Search Manager..." << endl << endl;
-		break;
+		cout << NOT_FOUND << endl;
+		return;
+	}
+
+	cout << "Which field do you wish to change? (name, alg, supply, year, price or founder)" << endl;
+	getline(cin, fieldName);
+	trimSpaces(fieldName);
+	fieldName = foldCase(fieldName);
+	cout << "What is the new value?" << endl;
+	getline(cin, text);
+	if (fieldName == "name")
+		normalizeStr(text);
+	else
+		trimSpaces(text);
+	if (!parseFieldValue(fieldName, text, field, value))
+	{
+		cout << "Please enter a valid field and value." << endl;
+		return;
 	}
 
+	// Only the name and the changed field are logged, the history is not copied
+	Cryptocurrency before;
+	before.setName(name);
+	UndoLog::copyField(field, *cryptoPtr.getCrypto(), before);
+	if (updateAll(name, field, value, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache))
+	{
+		undoLog->recordUpdate(field, before, *cryptoPtr.getCrypto());
+		cout << name << " has been updated!" << endl;
+	}
+	else
+	{
+		cout << "Update failed, the new name is taken or the key is too long." << endl;
+	}
 }
 
 /*
-	handling taking and running the command
+	read a batch file of changes and apply them as one transaction,
+	nothing is changed if a line or a change is invalid
 */
-void searchManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr)
+void batchFileManager(UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
-	char command;
-	displaytSearchSubMenu();
-	do
+	Transaction transaction;
+	ifstream inFile;
+	string fileName, line;
+	cout << "Enter the name of the batch file" << endl;
+	getline(cin, fileName);
+	trimSpaces(fileName);
+	inFile.open(fileName);
+	if (!inFile)
 	{
-		if (getInput(command, SEARCH_COMMANDS))
-			runSearchCommand(command, primaryTree, secondaryTree, hashArr);
-		// Using the last charactor in commands list as the exit command
-		// If command == last charactor in commands list, then break
-	} while (command != SEARCH_COMMANDS[SEARCH_COMMANDS.length() - 1]);
+		cout << "Error opening the batch file: \"" << fileName << "\"" << endl;
+		return;
+	}
+
+	transaction.begin();
+	for (int lineNumber = 1; getline(inFile, line); lineNumber++)
+	{
+		trimSpaces(line);
+		// Skip blank lines and comments
+		if (line.empty() || line[0] == '#')
+			continue;
+		if (!stageChange(line, transaction))
+		{
+			cout << "Line " << lineNumber << " is not a valid change: " << line << endl;
+			transaction.rollback();
+			cout << "Batch rejected, nothing was changed." << endl;
+			return;
+		}
+	}
+	inFile.close();
+
+	int count = transaction.getCount();
+	if (commitTransaction(transaction, undoLog, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache))
+		cout << count << " changes from " << fileName << " have been applied!" << endl;
+	else
+		cout << "Batch rejected, nothing was changed." << endl;
 }
 
-/* 
-	The template for searching in different data structure.  I am Meng, Meng is awesome.
+/*
+	apply a feed of price ticks from a file or a named pipe,
+	the ticks of each window are coalesced and applied as one batch
 */
-template<class T>
-void doSearch(T* dataStructure, string& key, void printCrypto(CryptocurrencyPtr&), bool searchFunction(T*, string, CryptocurrencyPtr&))
+void tickFeedManager(HashTable<CryptocurrencyPtr>* hashArr, SnapshotWriter* snapshotWriter)
 {
-	CryptocurrencyPtr resultCryptoPtr;
-
-	// Change the hashArr parameter to primary if you want to search in tree
-	//if (treeSearch(tree, name, resultCryptoPtr))
-	printHeader();
-	if (searchFunction(dataStructure, key, resultCryptoPtr))
+	ifstream feed;
+	string fileName;
+	vector<TickIngestor::Tick> batch;
+	long long batches = 0, applied = 0, unknown = 0, late = 0;
+	cout << "Enter the name of the tick file or pipe (lines of name,price,supply[,timestamp])" << endl;
+	getline(cin, fileName);
+	trimSpaces(fileName);
+	feed.open(fileName, ios::binary);
+	if (!feed)
 	{
-		printCrypto(resultCryptoPtr);
+		cout << "Error opening the tick feed: \"" << fileName << "\"" << endl;
+		return;
 	}
-	else {
-		cout << NOT_FOUND << endl;
+
+	// Feed names are matched like typed ones
+	TickIngestor ingestor(feed, TICK_WINDOW, TickIngestor::DEFAULT_MAX_TICKS, normalizeStr);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	while (ingestor.nextBatch(batch))
+	{
+		int stale = 0;
+		int found = applyTicks(batch, hashArr, snapshotWriter, stale);
+		batches++;
+		applied += found - stale;
+		late += stale;
+		unknown += (long long)batch.size() - found;
 	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << ingestor.getTickCount() << " ticks read in " << batches << " batches, "
+		<< applied << " price updates applied" << endl;
+	if (unknown > 0)
+		cout << unknown << " updates for coins not in the database were skipped" << endl;
+	if (late > 0)
+		cout << late << " updates older than the last recorded price were skipped" << endl;
+	if (ingestor.getBadLineCount() > 0)
+		cout << ingestor.getBadLineCount() << " malformed lines were skipped" << endl;
+	if (seconds > 0)
+		cout << (long long)(ingestor.getTickCount() / seconds) << " ticks per second" << endl;
 }
 
 /*
-	handling search opeartion in primary BST
+	set the price and supply of the coins in a batch of ticks, the coins are
+	looked up in the hash table a prefetch group at a time, return how many
+	were found; stale counts the found ones older than the coin's history
 */
-void primaryKeySearchManager(BinarySearchTree<CryptocurrencyPtr>* tree, void printCrypto(CryptocurrencyPtr&))
+int applyTicks(const vector<TickIngestor::Tick>& batch, HashTable<CryptocurrencyPtr>* hashArr, SnapshotWriter* snapshotWriter, int& stale)
 {
-	string name;
-	cout << "Please input the name of the Cryptocurrency: " << endl;
-	getline(cin, name);
-	trimSpaces(name);
-	doSearch<BinarySearchTree<CryptocurrencyPtr>>(tree, name, printCrypto, treeSearch);
+	string keys[PREFETCH_GROUP];
+	CryptocurrencyPtr results[PREFETCH_GROUP];
+	bool found[PREFETCH_GROUP];
+	int applied = 0;
+	for (size_t start = 0; start < batch.size(); start += PREFETCH_GROUP)
+	{
+		int n = batch.size() - start < (size_t)PREFETCH_GROUP ? (int)(batch.size() - start) : PREFETCH_GROUP;
+		// the ingestor has normalized the names
+		for (int i = 0; i < n; i++)
+			keys[i] = batch[start + i].name;
+		applied += hashArr->findMany(keys, n, results, found);
+		// Price and supply are not keys, the coins are changed in place
+		for (int i = 0; i < n; i++)
+		{
+			if (!found[i])
+				continue;
+			const TickIngestor::Tick& tick = batch[start + i];
+			Cryptocurrency* crypto = results[i].getCrypto();
+			if (snapshotWriter)
+				snapshotWriter->preserve(crypto);
+			// Timestamped prices are kept in the coin's history, a tick
+			// older than the last one recorded is stale and changes nothing
+			if (tick.timestamp >= 0)
+			{
+				if (!crypto->recordPrice(tick.timestamp, tick.price))
+				{
+					stale++;
+					continue;
+				}
+			}
+			else
+				crypto->setPrice(tick.price);
+			crypto->setSupply(tick.supply);
+		}
+	}
+	return applied;
 }
 
 /*
-	handling search opeartion in secondary BST
+	stage one line of a batch file, the lines look like
+		insert,name,algorithm,supply,year,price,founder
+		delete,name
+		update,name,field,value   (field: name, alg, supply, year, price or founder)
 */
-void secondaryKeySearchManager(BinarySearchTree<CryptocurrencyPtr>* tree, void printCrypto(CryptocurrencyPtr&))
+bool stageChange(const string& line, Transaction& transaction)
 {
-	string alg;
-	cout << "Please input the algorithm of the Cryptocurrency: " << endl;
-	getline(cin, alg);
-	trimSpaces(alg);
-	printHeader();
-	if (!tree->getAllEntry(CryptocurrencyPtr(nullptr, alg), printCrypto))
-		cout << NOT_FOUND << endl;
+	vector<string> fields;
+	string field;
+	stringstream lineStream(line);
+	while (getline(lineStream, field, ','))
+	{
+		trimSpaces(field);
+		fields.push_back(field);
+	}
+	if (fields.size() < 2)
+		return false;
+	// names are written the way insertManager and updateManager write them
+	normalizeStr(fields[1]);
+	if (fields[1].empty())
+		return false;
 
+	string op = foldCase(fields[0]);
+	if (op == "insert" && fields.size() == 7)
+	{
+		long long supply;
+		int year;
+		double price;
+		if (!parseValue(fields[3], supply) || supply < 0 ||
+			!parseValue(fields[4], year) || !yearValidator(year) ||
+			!parseValue(fields[5], price) || !priceValidator(price))
+			return false;
+		normalizeStr(fields[6]);
+		return transaction.insert(Cryptocurrency(fields[1], fields[2], supply, year, price, fields[6]));
+	}
+	if (op == "delete" && fields.size() == 2)
+		return transaction.remove(fields[1]);
+	if (op == "update" && fields.size() == 4)
+	{
+		UndoLog::Field target;
+		Cryptocurrency value;
+		string fieldName = foldCase(fields[2]);
+		if (fieldName == "name")
+			normalizeStr(fields[3]);
+		if (!parseFieldValue(fieldName, fields[3], target, value))
+			return false;
+		return transaction.update(fields[1], target, value);
+	}
+	return false;
 }
 
 /*
-	handling search opeartion in hash table
+	read the field named fieldName and its new value into value,
+	return false if the field is unknown or the value is invalid
 */
-void hashTableSearchManager(HashTable<CryptocurrencyPtr>* table, void printCrypto(CryptocurrencyPtr&))
+bool parseFieldValue(const string& fieldName, const string& text, UndoLog::Field& field, Cryptocurrency& value)
 {
-	string name;
-	cout << "Please input the name of the Cryptocurrency: " << endl;
-	getline(cin, name);
-	normalizeStr(name);
-	doSearch<HashTable<CryptocurrencyPtr>>(table, name, printCrypto, hashTableSearch);
+	long long supply;
+	int year;
+	double price;
+	if (fieldName == "name" && !text.empty())
+	{
+		field = UndoLog::NAME;
+		value.setName(text);
+	}
+	else if (fieldName == "alg" && !text.empty())
+	{
+		field = UndoLog::ALG;
+		value.setAlg(text);
+	}
+	else if (fieldName == "founder")
+	{
+		field = UndoLog::FOUNDER;
+		value.setFounder(text);
+	}
+	else if (fieldName == "supply" && parseValue(text, supply) && supply >= 0)
+	{
+		field = UndoLog::SUPPLY;
+		value.setSupply(supply);
+	}
+	else if (fieldName == "year" && parseValue(text, year) && yearValidator(year))
+	{
+		field = UndoLog::DATE;
+		value.setDate(year);
+	}
+	else if (fieldName == "price" && parseValue(text, price) && priceValidator(price))
+	{
+		field = UndoLog::PRICE;
+		value.setPrice(price);
+	}
+	else
+		return false;
+	return true;
 }
 
 /*
-	mapping the function to the corresponding command
+	read the whole text as one value, return false if anything is left over
 */
-void runListCommand(char& runCommand,
-	BinarySearchTree<CryptocurrencyPtr>* primaryTree,
-	BinarySearchTree<CryptocurrencyPtr>* secondaryTree,
-	HashTable<CryptocurrencyPtr>* hashArr)
+template<typename T>
+bool parseValue(const string& text, T& value)
 {
-	switch (runCommand)
+	stringstream textStream(text);
+	char extra;
+	return (textStream >> value) && !(textStream >> extra);
+}
+
+/*
+	check every staged change against the database and the changes
+	staged before it, then apply them all, or none if one would fail
+*/
+bool commitTransaction(Transaction& transaction, UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
+{
+	int inserts = transaction.getInsertCount();
+	vector<Transaction::Change> changes = transaction.takeChanges();
+
+	// The name each folded name has after the changes so far, empty once
+	// it is removed; a name is taken in any case, changed only as it is
+	unordered_map<string, string> staged;
+	auto exists = [&](string name)
+	{
+		auto it = staged.find(foldCase(name));
+		return it != staged.end() ? it->second == name : isKeyExists(name, primaryTree);
+	};
+	auto taken = [&](const string& name)
+	{
+		auto it = staged.find(foldCase(name));
+		return it != staged.end() ? !it->second.empty() : isNameTaken(name, nameIndex);
+	};
+	for (size_t i = 0; i < changes.size(); i++)
+	{
+		const Transaction::Change& change = changes[i];
+		bool valid;
+		switch (change.type)
+		{
+		case UndoLog::OP_INSERT:
+			valid = FixedKey::fits(change.name) && FixedKey::fits(change.record.getAlg()) && !taken(change.name);
+			staged[foldCase(change.name)] = change.name;
+			break;
+		case UndoLog::OP_DELETE:
+			valid = exists(change.name);
+			staged[foldCase(change.name)] = "";
+			break;
+		default:
+			valid = exists(change.name);
+			if (change.field == UndoLog::NAME)
+			{
+				string newName = change.record.getName();
+				staged[foldCase(change.name)] = "";
+				valid = valid && FixedKey::fits(newName) && !taken(newName);
+				staged[foldCase(newName)] = newName;
+			}
+			else if (change.field == UndoLog::ALG)
+				valid = valid && FixedKey::fits(change.record.getAlg());
+			break;
+		}
+		if (!valid)
+		{
+			cout << "Change " << i + 1 << ", " << describeAction(change) << ", cannot be applied: "
+				<< "the Cryptocurrency is not found, already exists or has a too long key." << endl;
+			return false;
+		}
+	}
+
+	// Every change is known to succeed now. The writes thaw the trees, which
+	// are searched while the batch is applied, and their flat arrays are
+	// rebuilt once at the end; the hash table rehashes at most once up front
+	primaryTree->thaw();
+	secondaryTree->thaw();
+	hashArr->reserve(hashArr->getSize() + inserts);
+
+	// The batch is logged as one operation, undone and redone whole
+	undoLog->beginGroup();
+	for (const Transaction::Change& change : changes)
+	{
+		Cryptocurrency* crypto;
+		CryptocurrencyPtr cryptoPtr;
+		switch (change.type)
+		{
+		case UndoLog::OP_INSERT:
+			crypto = new Cryptocurrency(change.record);
+			insertAll(*crypto, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+			undoLog->recordInsert(*crypto);
+			break;
+		case UndoLog::OP_DELETE:
+			crypto = removeAll(change.name, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+			undoLog->recordDelete(*crypto);
+			delete crypto;
+			break;
+		case UndoLog::OP_UPDATE:
+		{
+			treeSearch(primaryTree, change.name, cryptoPtr);
+			crypto = cryptoPtr.getCrypto();
+			Cryptocurrency before;
+			before.setName(change.name);
+			UndoLog::copyField(change.field, *crypto, before);
+			updateAll(change.name, change.field, change.record, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+			undoLog->recordUpdate(change.field, before, *crypto);
+			break;
+		}
+		}
+	}
+	undoLog->endGroup();
+
+	primaryTree->freeze();
+	secondaryTree->freeze();
+	return true;
+}
+
+/*
+	search in BST, return ture if found, else false
+*/
+bool treeSearch(BinarySearchTree<CryptocurrencyPtr>* tree, string key, CryptocurrencyPtr& result)
+{
+	if (tree->getEntry(CryptocurrencyPtr(nullptr, key), result))
+		return true;
+	else
+		return false;
+}
+
+/*
+	search in hash table, return ture if found, else false
+*/
+bool hashTableSearch(HashTable<CryptocurrencyPtr>* table, string key, CryptocurrencyPtr& result)
+{
+	if (table->findItem(key, result))
+		return true;
+	else
+		return false;
+}
+
+/*
+	handling calling function with corresponding command
+*/
+void runSearchCommand(char& runCommand,
+	BinarySearchTree<CryptocurrencyPtr>* primaryTree,
+	BinarySearchTree<CryptocurrencyPtr>* secondaryTree,
+	HashTable<CryptocurrencyPtr>* hashArr,
+	RadixTree<CryptocurrencyPtr>* nameIndex,
+	QueryCache* queryCache)
+{
+	switch (runCommand)
 	{
 	case 'A':
-		cout << "Printing the hash table in unsorted list:" << endl;
-		hashArr->printTable(printHeader, printCrypto);
-		cout << "Load factor: " << hashArr->getLoadFactor() << "%" << endl;
+		primaryKeySearchManager(primaryTree, printCrypto);
+		cout << divider(80, '=') << endl << endl;
 		break;
 	case 'B':
-		cout << "Printing the primary tree in sorted list:" << endl;
-		printHeader();
-		primaryTree->inOrder(printCrypto);
+		secondaryKeySearchManager(secondaryTree, queryCache, printCrypto);
 		cout << divider(80, '=') << endl << endl;
 		break;
 	case 'C':
-		cout << "Printing the secondary tree in sorted list:" << endl;
-		printHeader();
-		secondaryTree->inOrder(printCrypto);
+		hashTableSearchManager(hashArr, printCrypto);
 		cout << divider(80, '=') << endl << endl;
 		break;
 	case 'D':
+		prefixSearchManager(nameIndex, printCrypto);
+		cout << divider(80, '=') << endl << endl;
+		break;
+	case 'E':
+		fuzzySearchManager(nameIndex, printCrypto);
+		cout << divider(80, '=') << endl << endl;
+		break;
+	case 'F':
+		batchSearchManager(hashArr, printCrypto);
+		cout << divider(80, '=') << endl << endl;
+		break;
+	case 'G':
+		historySearchManager(hashArr);
+		cout << divider(80, '=') << endl << endl;
+		break;
+	case 'H':
+		displaytSearchSubMenu();
+		break;
+	case 'I':
+		cout << "Exiting Search Manager..." << endl << endl;
+		break;
+	}
+
+}
+
+/*
+	handling taking and running the command
+*/
+void searchManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, QueryCache* queryCache)
+{
+	char command;
+	displaytSearchSubMenu();
+	do
+	{
+		if (getInput(command, SEARCH_COMMANDS))
+			runSearchCommand(command, primaryTree, secondaryTree, hashArr, nameIndex, queryCache);
+		// Using the last charactor in commands list as the exit command
+		// If command == last charactor in commands list, then break
+	} while (command != SEARCH_COMMANDS[SEARCH_COMMANDS.length() - 1]);
+}
+
+/* 
+	The template for searching in different data structure.  I am Meng, Meng is awesome.
+*/
+template<class T>
+void doSearch(T* dataStructure, string& key, void printCrypto(CryptocurrencyPtr&), bool searchFunction(T*, string, CryptocurrencyPtr&))
+{
+	CryptocurrencyPtr resultCryptoPtr;
+
+	// Change the hashArr parameter to primary if you want to search in tree
+	//if (treeSearch(tree, name, resultCryptoPtr))
+	printHeader();
+	if (searchFunction(dataStructure, key, resultCryptoPtr))
+	{
+		printCrypto(resultCryptoPtr);
+	}
+	else {
+		cout << NOT_FOUND << endl;
+	}
+}
+
+/*
+	handling search opeartion in primary BST
+*/
+void primaryKeySearchManager(BinarySearchTree<CryptocurrencyPtr>* tree, void printCrypto(CryptocurrencyPtr&))
+{
+	string name;
+	cout << "Please input the name of the Cryptocurrency: " << endl;
+	getline(cin, name);
+	trimSpaces(name);
+	doSearch<BinarySearchTree<CryptocurrencyPtr>>(tree, name, printCrypto, treeSearch);
+}
+
+/*
+	handling search opeartion in secondary BST
+*/
+void secondaryKeySearchManager(BinarySearchTree<CryptocurrencyPtr>* tree, QueryCache* queryCache, void printCrypto(CryptocurrencyPtr&, RowWriter&))
+{
+	string alg;
+	vector<CryptocurrencyPtr> entries;
+	cout << "Please input the algorithm of the Cryptocurrency: " << endl;
+	getline(cin, alg);
+	trimSpaces(alg);
+	// The same search is answered from the cache until a coin of alg changes
+	const vector<CryptocurrencyPtr>* found = queryCache->find(QueryCache::BY_ALG, alg);
+	if (!found)
+	{
+		CryptocurrencyPtr key(nullptr, alg);
+		tree->rangeOutput(key, key, visitCollect, entries);
+		found = queryCache->store(QueryCache::BY_ALG, alg, entries);
+		if (!found)
+			found = &entries;
+	}
+	RowWriter row(cout);
+	printHeader(row);
+	if (found->empty())
+		row.put(NOT_FOUND).newline();
+	for (CryptocurrencyPtr entry : *found)
+		printCrypto(entry, row);
+	row.flush();
+}
+
+/*
+	handling search opeartion in hash table
+*/
+void hashTableSearchManager(HashTable<CryptocurrencyPtr>* table, void printCrypto(CryptocurrencyPtr&))
+{
+	string name;
+	cout << "Please input the name of the Cryptocurrency: " << endl;
+	getline(cin, name);
+	normalizeStr(name);
+	doSearch<HashTable<CryptocurrencyPtr>>(table, name, printCrypto, hashTableSearch);
+}
+
+/*
+	handling search by the beginning of the name in the name index
+*/
+void prefixSearchManager(RadixTree<CryptocurrencyPtr>* nameIndex, void printCrypto(CryptocurrencyPtr&, RowWriter&))
+{
+	string prefix;
+	cout << "Please input the beginning of the name of the Cryptocurrency: " << endl;
+	getline(cin, prefix);
+	trimSpaces(prefix);
+	RowWriter row(cout);
+	printHeader(row);
+	if (nameIndex->prefixSearch(foldCase(prefix), printCrypto, row, 0) == 0)
+		row.put(NOT_FOUND).newline();
+	row.flush();
+}
+
+/*
+	handling approximate name search in the name index
+*/
+void fuzzySearchManager(RadixTree<CryptocurrencyPtr>* nameIndex, void printCrypto(CryptocurrencyPtr&, RowWriter&))
+{
+	string name;
+	cout << "Please input the name of the Cryptocurrency: " << endl;
+	getline(cin, name);
+	trimSpaces(name);
+	RowWriter row(cout);
+	printHeader(row);
+	if (nameIndex->fuzzySearch(foldCase(name), FUZZY_DISTANCE, printCrypto, row) == 0)
+		row.put(NOT_FOUND).newline();
+	row.flush();
+}
+
+/*
+	handling a search for a comma separated list of names in the hash table
+*/
+void batchSearchManager(HashTable<CryptocurrencyPtr>* table, void printCrypto(CryptocurrencyPtr&, RowWriter&))
+{
+	string line, name;
+	vector<string> names;
+	cout << "Please input the names of the Cryptocurrencies, separated by commas: " << endl;
+	getline(cin, line);
+	istringstream nameStream(line);
+	while (getline(nameStream, name, ','))
+	{
+		normalizeStr(name);
+		if (!name.empty())
+			names.push_back(name);
+	}
+	if (names.empty())
+	{
+		cout << NOT_FOUND << endl;
+		return;
+	}
+
+	// Looked up together so the hash table can overlap the bucket reads
+	vector<CryptocurrencyPtr> results(names.size());
+	unique_ptr<bool[]> found(new bool[names.size()]);
+	int numFound = table->findMany(names.data(), (int)names.size(), results.data(), found.get());
+	RowWriter row(cout);
+	printHeader(row);
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (found[i])
+			printCrypto(results[i], row);
+		else
+			row.put(names[i]).put(": ").put(NOT_FOUND).newline();
+	}
+	row.put(numFound).put(" of ").put((long long)names.size()).put(" found").newline();
+	row.flush();
+}
+
+/*
+	show the recorded prices of a cryptocurrency in a time range,
+	every price or downsampled to intervals of a given width
+*/
+void historySearchManager(HashTable<CryptocurrencyPtr>* table)
+{
+	CryptocurrencyPtr cryptoPtr;
+	string name, line;
+	long long from, to, width = 0;
+	cout << "Please input the name of the Cryptocurrency: " << endl;
+	getline(cin, name);
+	normalizeStr(name);
+	if (!hashTableSearch(table, name, cryptoPtr))
+	{
+		cout << NOT_FOUND << endl;
+		return;
+	}
+	const PriceHistory* history = cryptoPtr.getCrypto()->getHistory();
+	if (!history || history->isEmpty())
+	{
+		cout << "No price history has been recorded for " << name << endl;
+		return;
+	}
+
+	from = history->getFirstTime();
+	to = history->getLastTime();
+	cout << "Please input the start and end time, or press enter for the whole history (" << from << " to " << to << "): " << endl;
+	getline(cin, line);
+	istringstream rangeStream(line);
+	if (!line.empty() && (!(rangeStream >> from >> to) || from > to))
+	{
+		cout << "Please enter a valid time range." << endl;
+		return;
+	}
+	cout << "Please input the interval width to downsample to, or press enter to list every price: " << endl;
+	getline(cin, line);
+	trimSpaces(line);
+	if (!line.empty() && (!parseValue(line, width) || width <= 0))
+	{
+		cout << "Please enter a valid interval width." << endl;
+		return;
+	}
+
+	RowWriter row(cout);
+	if (width == 0)
+	{
+		vector<PriceHistory::Point> points;
+		history->range(from, to, points);
+		row.left("Time", 16).put("Price").newline();
+		for (const PriceHistory::Point& point : points)
+			row.left(point.timestamp, 16).put('$').put(point.price).newline();
+		row.put((long long)points.size()).put(" prices").newline();
+	}
+	else
+	{
+		vector<PriceHistory::Bar> bars;
+		history->downsample(from, to, width, bars);
+		row.left("Time", 16).left("Open", 12).left("High", 12).left("Low", 12).left("Close", 12).put("Count").newline();
+		for (const PriceHistory::Bar& bar : bars)
+			row.left(bar.timestamp, 16).left(bar.open, 12).left(bar.high, 12).left(bar.low, 12).left(bar.close, 12).put(bar.count).newline();
+		row.put((long long)bars.size()).put(" intervals").newline();
+	}
+	row.flush();
+}
+
+/*
+	mapping the function to the corresponding command
+*/
+void runListCommand(char& runCommand,
+	BinarySearchTree<CryptocurrencyPtr>* primaryTree,
+	BinarySearchTree<CryptocurrencyPtr>* secondaryTree,
+	HashTable<CryptocurrencyPtr>* hashArr,
+	QueryCache* queryCache)
+{
+	switch (runCommand)
+	{
+	case 'A':
+	{
+		RowWriter row(cout);
+		row.put("Printing the hash table in unsorted list:").newline();
+		hashArr->printTable(printHeader, printBucket, printCrypto, row);
+		row.put("Load factor: ").put(hashArr->getLoadFactor()).put('%').newline();
+		row.flush();
+		break;
+	}
+	case 'B':
+		cout << "Printing the primary tree in sorted list:" << endl;
+		printSortedList(primaryTree, queryCache, QueryCache::SORTED_BY_NAME);
+		break;
+	case 'C':
+		cout << "Printing the secondary tree in sorted list:" << endl;
+		printSortedList(secondaryTree, queryCache, QueryCache::SORTED_BY_ALG);
+		break;
+	case 'D':
+	{
 		// Speacial print
-		primaryTree->indentedTraversal(visitIndented);
+		RowWriter row(cout);
+		primaryTree->indentedTraversal(visitIndented, row);
 		//primaryTree->print(print1);
-		cout << endl;
+		row.newline();
+		row.flush();
 		break;
+	}
 	case 'E':
+	{
 		// Hidden Print
-		hashArr->printInfo(printHeader, printCrypto);
+		RowWriter row(cout);
+		hashArr->printInfo(printHeader, printBucket, printCrypto, row);
+		row.put("Number of collisions: ").put(hashArr->getCollision()).newline();
+		row.flush();
 		break;
+	}
 	case 'F':
-		displaytListSubMenu();
+		pageManager(primaryTree, queryCache, printCrypto);
+		cout << divider(80, '=') << endl << endl;
 		break;
 	case 'G':
+		displaytListSubMenu();
+		break;
+	case 'H':
 		cout << "Exiting List Manager..." << endl << endl;
 		break;
 	}
-
+
+}
+
+/*
+	for handling operations in listing and printing
+*/
+void listManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, QueryCache* queryCache)
+{
+	char command;
+	displaytListSubMenu();
+	do
+	{
+		if (getInput(command, LIST_COMMANDS))
+			runListCommand(command, primaryTree, secondaryTree, hashArr, queryCache);
+		// Using the last charactor in commands list as the exit command
+		// If command == last charactor in commands list, then break
+	} while (command != LIST_COMMANDS[LIST_COMMANDS.length() - 1]);
+}
+
+/*
+	handling paged listing of the primary BST, a page is kept in the
+	query cache under its number and size
+*/
+void pageManager(BinarySearchTree<CryptocurrencyPtr>* tree, QueryCache* queryCache, void printCrypto(CryptocurrencyPtr&, RowWriter&))
+{
+	int pageSize, pageNum, totalPages;
+	while (!getInsertData(pageSize, "How many Cryptocurrencies per page?", positiveValidator))
+	{
+		cout << "Please enter a valid page size." << endl;
+	}
+	totalPages = (tree->size() + pageSize - 1) / pageSize;
+	while (!getInsertData(pageNum, "Which page? (1 - " + to_string(totalPages) + ")", positiveValidator))
+	{
+		cout << "Please enter a valid page." << endl;
+	}
+	vector<CryptocurrencyPtr> entries;
+	string query = to_string(pageNum) + "," + to_string(pageSize);
+	const vector<CryptocurrencyPtr>* found = queryCache->find(QueryCache::PAGE_BY_NAME, query);
+	if (!found)
+	{
+		// the tree pages are counted from 0
+		tree->getPage(pageNum - 1, pageSize, visitCollect, entries);
+		found = queryCache->store(QueryCache::PAGE_BY_NAME, query, entries);
+		if (!found)
+			found = &entries;
+	}
+	RowWriter row(cout);
+	printHeader(row);
+	for (CryptocurrencyPtr entry : *found)
+		printCrypto(entry, row);
+	if (found->empty())
+		row.put("Page ").put(pageNum).put(" is empty.").newline();
+	else
+		row.put("Page ").put(pageNum).put(" of ").put(totalPages).newline();
+	row.flush();
+}
+
+/*
+	print a tree in order, from the query cache when it holds the listing
+*/
+void printSortedList(BinarySearchTree<CryptocurrencyPtr>* tree, QueryCache* queryCache, QueryCache::Kind kind)
+{
+	vector<CryptocurrencyPtr> entries;
+	const vector<CryptocurrencyPtr>* found = queryCache->find(kind, "");
+	if (!found)
+	{
+		entries.reserve(tree->size());
+		tree->inOrderOutput(visitCollect, entries);
+		found = queryCache->store(kind, "", entries);
+		if (!found)
+			found = &entries;
+	}
+	RowWriter row(cout);
+	printHeader(row);
+	for (CryptocurrencyPtr entry : *found)
+		printCrypto(entry, row);
+	row.fill('=', 80).newline().newline();
+	row.flush();
+}
+
+/*
+	undo the most recent insert, delete or update
+*/
+void undo(UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
+{
+	vector<UndoLog::Action> actions;
+	if (undoLog->undo(actions))
+	{
+		// A batch is undone whole, from its last change back
+		bool applied = true;
+		for (const UndoLog::Action& action : actions)
+		{
+			cout << "Undo: " + describeAction(action) + " ..." << endl;
+			applied = applyAction(action, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache) && applied;
+		}
+		if (applied)
+			cout << "Undo successful!" << endl;
+		else
+			cout << "Undo Failed, the Cryptocurrency was not found or the key already exists." << endl;
+	}
+	else
+	{
+		cout << "Nothing to undo." << endl;
+	}
 }
 
 /*
-	for handling operations in listing and printing
+	redo the most recently undone change
 */
-void listManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr)
+void redo(UndoLog* undoLog, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
-	char command;
-	displaytListSubMenu();
-	do
+	vector<UndoLog::Action> actions;
+	if (undoLog->redo(actions))
 	{
-		if (getInput(command, LIST_COMMANDS))
-			runListCommand(command, primaryTree, secondaryTree, hashArr);
-		// Using the last charactor in commands list as the exit command
-		// If command == last charactor in commands list, then break
-	} while (command != LIST_COMMANDS[LIST_COMMANDS.length() - 1]);
+		bool applied = true;
+		for (const UndoLog::Action& action : actions)
+		{
+			cout << "Redo: " + describeAction(action) + " ..." << endl;
+			applied = applyAction(action, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache) && applied;
+		}
+		if (applied)
+			cout << "Redo successful!" << endl;
+		else
+			cout << "Redo Failed, the Cryptocurrency was not found or the key already exists." << endl;
+	}
+	else
+	{
+		cout << "Nothing to redo." << endl;
+	}
 }
 
 /*
-	undo the most recent deletion
+	apply an action from the undo log to the trees, hash table and name index
 */
-void undo(Stack<Cryptocurrency*>* undoStack, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr)
+bool applyAction(const UndoLog::Action& action, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, SnapshotWriter* snapshotWriter, QueryCache* queryCache)
 {
-	Cryptocurrency* poppedItem;
-	if (undoStack->pop(poppedItem))
+	Cryptocurrency* crypto;
+	switch (action.type)
 	{
-		cout << "Undo deleting " + poppedItem->getName() + " ..." << endl;
-		if (insertAll(*poppedItem, primaryTree, secondaryTree, hashArr))
-			cout << "Undo successful!" << endl;
-		else
-			cout << "Undo Failed, Key Already Exists." << endl;
+	case UndoLog::OP_INSERT:
+		crypto = new Cryptocurrency(action.record);
+		if (insertAll(*crypto, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache))
+			return true;
+		delete crypto;
+		return false;
+	case UndoLog::OP_DELETE:
+		crypto = removeAll(action.name, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
+		delete crypto;
+		return crypto != nullptr;
+	case UndoLog::OP_UPDATE:
+		return updateAll(action.name, action.field, action.record, primaryTree, secondaryTree, hashArr, nameIndex, snapshotWriter, queryCache);
 	}
-	else
+	return false;
+}
+
+/*
+	describe an action from the undo log for the user
+*/
+string describeAction(const UndoLog::Action& action)
+{
+	switch (action.type)
 	{
-		cout << "Undo Stack is Empty." << endl;
+	case UndoLog::OP_INSERT:
+		return "adding " + action.name;
+	case UndoLog::OP_DELETE:
+		return "deleting " + action.name;
+	case UndoLog::OP_UPDATE:
+		return "changing " + action.name;
 	}
+	return "";
 }
 
 /*
@@ -778,33 +1796,57 @@ void undo(Stack<Cryptocurrency*>* undoStack, BinarySearchTree<CryptocurrencyPtr>
 */
 void printHashTableStats(HashTable<CryptocurrencyPtr>* hashArr)
 {
-	cout << endl << "Statistics for cryptocurrency hash table: " << endl;
-	cout << divider(80, '=') << endl;
-	cout << left;
-	cout << setw(10) << "Capacity" << setw(15) << "Counts";
-	cout << setw(15) << "Load Factor (%)" << setw(15) << "Collisions";
-	cout << setw(20) << "Total Item Stored" << endl;
-	cout << divider(80, '=') << endl;
-	cout << setw(10) << hashArr->getCapacity() << setw(15) << hashArr->getSize();
-	cout << setw(15) << hashArr->getLoadFactor() << setw(15) << hashArr->getCollision();
-	cout << setw(20) << hashArr->getSize() + hashArr->getCollision() << endl;
-	cout << divider(80, '=') << endl;
+	RowWriter row(cout);
+	row.newline().put("Statistics for cryptocurrency hash table: ").newline();
+	row.fill('=', 80).newline();
+	row.left("Capacity", 10).left("Counts", 15);
+	row.left("Load Factor (%)", 15).left("Collisions", 15);
+	row.left("Total Item Stored", 20).newline();
+	row.fill('=', 80).newline();
+	row.left(hashArr->getCapacity(), 10).left(hashArr->getSize(), 15);
+	row.left(hashArr->getLoadFactor(), 15).left(hashArr->getCollision(), 15);
+	row.left(hashArr->getSize() + hashArr->getCollision(), 20).newline();
+	row.fill('=', 80).newline();
+	row.flush();
+}
+
+/*
+	print the memory held by each index in a table format
+*/
+void printMemoryStats(BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex, UndoLog* undoLog, QueryCache* queryCache, SnapshotWriter* snapshotWriter)
+{
+	size_t total = primaryTree->memoryUsage() + secondaryTree->memoryUsage() + hashArr->memoryUsage() + nameIndex->memoryUsage() + undoLog->memoryUsage() + queryCache->memoryUsage() + snapshotWriter->memoryUsage();
+	RowWriter row(cout);
+	row.newline().put("Memory used by the indexes: ").newline();
+	row.fill('=', 80).newline();
+	row.left("Index", 20).left("Entries", 15).left("Bytes", 15).newline();
+	row.fill('=', 80).newline();
+	row.left("Primary tree", 20).left(primaryTree->size(), 15).left((long long)primaryTree->memoryUsage(), 15).newline();
+	row.left("Secondary tree", 20).left(secondaryTree->size(), 15).left((long long)secondaryTree->memoryUsage(), 15).newline();
+	row.left("Hash table", 20).left(hashArr->getSize() + hashArr->getCollision(), 15).left((long long)hashArr->memoryUsage(), 15).newline();
+	row.left("Name index", 20).left(nameIndex->size(), 15).left((long long)nameIndex->memoryUsage(), 15).newline();
+	row.left("Undo log", 20).left(undoLog->getUndoCount() + undoLog->getRedoCount(), 15).left((long long)undoLog->memoryUsage(), 15).newline();
+	row.left("Query cache", 20).left(queryCache->getEntryCount(), 15).left((long long)queryCache->memoryUsage(), 15).newline();
+	row.left("Snapshot tree", 20).left(snapshotWriter->getCoinCount(), 15).left((long long)snapshotWriter->memoryUsage(), 15).newline();
+	row.left("Total", 35).left((long long)total, 15).newline();
+	row.fill('=', 80).newline();
+	row.put("Query cache: ").put(queryCache->getHits()).put(" hits, ").put(queryCache->getMisses()).put(" misses").newline();
+	row.flush();
 }
 
 /*
 	visit function for speacial print
 */
-void visitIndented(int level, CryptocurrencyPtr& cryptoPtr)
+void visitIndented(int level, CryptocurrencyPtr& cryptoPtr, RowWriter& row)
 {
-	for (int i = 0; i < level; i++)
-		cout << "\t";
-	cout << "Level " << level + 1 << ": " << cryptoPtr.getCrypto()->getName() << endl;
+	row.fill('\t', level);
+	row.put("Level ").put(level + 1).put(": ").put(cryptoPtr.getCrypto()->getName()).newline();
 }
 
 /*
 	write data in trees to the file
 */
-void writeData(BinarySearchTree <CryptocurrencyPtr>* primaryTree, string outFileName, Stack<Cryptocurrency*>* undoStack)
+void writeData(BinarySearchTree <CryptocurrencyPtr>* primaryTree, string outFileName)
 {
 	ofstream textFile;
 	textFile.open(outFileName.c_str());
@@ -814,55 +1856,167 @@ void writeData(BinarySearchTree <CryptocurrencyPtr>* primaryTree, string outFile
 		cout << "Cannot open file: " + outFileName << endl;
 		return;
 	}
-	textFile << "Cryptocurrency Database" << endl;
-	textFile << endl;
-
-	textFile << "============= ============= ============ ======= ======== =====================" << endl;
-	textFile << "Algorithm     Supply        Founder      Year    Price    Coin Name" << endl;
-	textFile << "============= ============= ============ ======= ======== =====================" << endl;
-
-	primaryTree->inOrderOutput(visitPrint, textFile);
-	clearStack(undoStack);
+	exportTo(primaryTree, Exporter::TEXT, textFile);
 	cout << "Data writen to " + outFileName << endl;
-	cout << "Undo stack cleared!" << endl;
 
 	textFile.close();
 }
 
 /*
-	visit function for printing
+	take a version of the coins in primary key order and hand it to the
+	snapshot thread, which writes it to the file while the commands go on;
+	a coin is copied only if it is changed before the thread gets to it
+*/
+void snapshotData(SnapshotWriter* snapshotWriter, const string& outFileName)
+{
+	// one snapshot at a time
+	snapshotWriter->wait();
+	reportSnapshot(snapshotWriter);
+	cout << "Writing " << snapshotWriter->getCoinCount() << " Cryptocurrencies to " + outFileName + " in the background" << endl;
+	snapshotWriter->start(Exporter::TEXT, outFileName);
+}
+
+/*
+	visit function collecting the entries of a tree
+*/
+void visitCollect(CryptocurrencyPtr& a, vector<CryptocurrencyPtr>& items)
+{
+	items.push_back(a);
+}
+
+/*
+	tell the user about a snapshot that finished since the last command
+*/
+void reportSnapshot(SnapshotWriter* snapshotWriter)
+{
+	SnapshotWriter::Result result;
+	if (!snapshotWriter->takeResult(result))
+		return;
+	if (result.written)
+		cout << "Data writen to " + result.fileName << endl;
+	else
+		cout << "Cannot write file: " + result.fileName << endl;
+}
+
+/*
+	ask for a format, a file name and whether the file is written on a
+	background thread, then export the coins in primary key order
+*/
+void exportManager(BinarySearchTree<CryptocurrencyPtr>* primaryTree)
+{
+	string choice, fileName;
+	size_t formatIndex;
+	cout << "Enter the export format (C - CSV, J - NDJSON, B - columnar binary, T - text listing)" << endl;
+	getline(cin, choice);
+	trimSpaces(choice);
+	if (choice.size() != 1 || (formatIndex = EXPORT_FORMATS.find((char)toupper(choice[0]))) == string::npos)
+	{
+		cout << choice << " is not an export format." << endl;
+		return;
+	}
+	Exporter::Format format = (Exporter::Format)formatIndex;
+
+	string defaultName = string("SortedOutput.") + Exporter::extension(format);
+	cout << "Enter the name of the export file (nothing for " << defaultName << ")" << endl;
+	getline(cin, fileName);
+	trimSpaces(fileName);
+	if (fileName.empty())
+		fileName = defaultName;
+
+	cout << "Write the file on a background thread? (Y/N)" << endl;
+	getline(cin, choice);
+	trimSpaces(choice);
+	exportData(primaryTree, format, fileName, !choice.empty() && toupper(choice[0]) == 'Y');
+}
+
+/*
+	export the coins to a file, the rows are formatted on this thread and
+	written either here or by a background thread; return false if the
+	file could not be written
+*/
+bool exportData(BinarySearchTree<CryptocurrencyPtr>* primaryTree, Exporter::Format format, const string& fileName, bool background)
+{
+	ofstream file(fileName, ios::binary);
+	int count;
+	bool written;
+	if (!file)
+	{
+		cout << "Cannot open file: " + fileName << endl;
+		return false;
+	}
+	if (background)
+	{
+		BackgroundWriter writer(file);
+		count = exportTo(primaryTree, format, writer.stream());
+		written = writer.finish();
+	}
+	else
+	{
+		count = exportTo(primaryTree, format, file);
+		file.flush();
+		written = file.good();
+	}
+	if (!written)
+	{
+		cout << "Error writing file: " + fileName << endl;
+		return false;
+	}
+	cout << count << " Cryptocurrencies exported to " + fileName << endl;
+	return true;
+}
+
+/*
+	stream the in-order traversal through an exporter, return how many
+	coins were written
 */
-void visitPrint(CryptocurrencyPtr& a, ofstream& outFile)
+int exportTo(BinarySearchTree<CryptocurrencyPtr>* primaryTree, Exporter::Format format, ostream& stream)
 {
-	Cryptocurrency dummy = *a.getCrypto();
-	outFile << left;
-	outFile << setw(13) << dummy.getAlg() << " " << setw(13) << dummy.getSupply() << " " << setw(12) << dummy.getFounder()
-		<< " " << setw(7) << dummy.getDate() << " " << setw(8) << dummy.getPrice() << " " << setw(22) << dummy.getName() << endl;
+	RowWriter out(stream);
+	Exporter* exporter = Exporter::create(format, out);
+	exporter->begin();
+	primaryTree->inOrderOutput(visitExport, *exporter);
+	exporter->end();
+	int count = exporter->getCount();
+	delete exporter;
+	return count;
 }
 
 /*
-	clear the undo stack
+	visit function for exporting
 */
-void clearStack(Stack<Cryptocurrency*>* undoStack)
+void visitExport(CryptocurrencyPtr& a, Exporter& exporter)
 {
-	Cryptocurrency* tmp;
-	while (undoStack->pop(tmp))
-		delete tmp;
+	exporter.write(*a.getCrypto());
+}
+
+/*
+	delete the cryptocurrency a primary tree entry points to
+*/
+void deleteCrypto(CryptocurrencyPtr& cryptoPtr)
+{
+	delete cryptoPtr.getCrypto();
 }
 
 /*
 	delete all memory and exit the program:
 */
-void exit(Stack<Cryptocurrency*>* undoStack, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr)
+void exit(UndoLog* undoLog, SnapshotWriter* snapshotWriter, QueryCache* queryCache, BinarySearchTree<CryptocurrencyPtr>* primaryTree, BinarySearchTree<CryptocurrencyPtr>* secondaryTree, HashTable<CryptocurrencyPtr>* hashArr, RadixTree<CryptocurrencyPtr>* nameIndex)
 {
-	cout << "Deleting Undo Stack..." << endl;
-	delete undoStack;
+	cout << "Deleting Undo Log..." << endl;
+	delete undoLog;
+	delete snapshotWriter;
+	delete queryCache;
+	// Every stored cryptocurrency has exactly one primary tree entry
+	cout << "Deleting Cryptocurrencies..." << endl;
+	primaryTree->inOrder(deleteCrypto);
 	cout << "Deleting Primary Tree..." << endl;
 	delete primaryTree;
 	cout << "Deleting Secondary Tree..." << endl;
 	delete secondaryTree;
 	cout << "Deleting hash table..." << endl;
 	delete hashArr;
+	cout << "Deleting name index..." << endl;
+	delete nameIndex;
 }
 
 /*
@@ -899,6 +2053,18 @@ void normalizeStr(string& str)
 	str = result;
 }
 
+/*
+	lowercase copy of the string, the name index ignores case
+*/
+string foldCase(const string& str)
+{
+	string result = str;
+	// tolower takes the byte as an unsigned char, a negative char is undefined
+	for (char& c : result)
+		c = (char)tolower((unsigned char)c);
+	return result;
+}
+
 /*
 	print the welcome message!
 */
@@ -918,3 +2084,324 @@ void printWelcome()
 	cout << "\tProject Documentation: Tommy Vu & Steven Vu";
 	cout << "\n\n\t ============== -CryptoCurrencies- ==============\n\n";
 }
+
+/*
+	run the database split into shards by the hash of the name,
+	each shard with its own trees, hash table and lock
+*/
+int shardedMain(const string& inputFileName, int shardCount)
+{
+	ShardedDatabase* database = new ShardedDatabase(shardCount, getNumberOfLines(inputFileName));
+	loadShards(inputFileName, database);
+
+	displayShardMenu();
+
+	char command;
+	do
+	{
+		if (getInput(command, SHARD_COMMANDS))
+			runShardCommand(command, database);
+
+	} while (command != SHARD_COMMANDS[SHARD_COMMANDS.length() - 1]);
+	cout << "Bye! Thanks for using the Cryptocurrency Database!" << endl;
+	return 0;
+}
+
+/*
+	run the coresponding function of the sharded database with given command
+*/
+void runShardCommand(char& command, ShardedDatabase* database)
+{
+	vector<Cryptocurrency> cryptos;
+	switch (command)
+	{
+	case 'A':
+		shardInsertManager(database);
+		break;
+	case 'B':
+		shardDeleteManager(database);
+		break;
+	case 'C':
+		shardNameSearchManager(database);
+		break;
+	case 'D':
+		shardAlgSearchManager(database);
+		break;
+	case 'E':
+		shardRangeManager(database);
+		break;
+	case 'F':
+		// Every shard's tree merged into one list
+		database->listByName(cryptos);
+		printCryptos(cryptos);
+		break;
+	case 'G':
+		database->listByAlg(cryptos);
+		printCryptos(cryptos);
+		break;
+	case 'H':
+		printShardStats(database);
+		break;
+	case 'I':
+		displayShardMenu();
+		break;
+	case 'J':
+		writeShardData(database, "SortedOutput.txt");
+		cout << "Deleting shards..." << endl;
+		delete database;
+		break;
+	}
+}
+
+/*
+	display the menu of the sharded database
+*/
+void displayShardMenu()
+{
+	cout << "Welcome to our sharded Cryptocurrency Database! Please select one of the following commands!" << endl;
+	cout << "" << endl;
+	cout << "A - Add new a Cryptocurrency " << endl;
+	cout << "B - Delete a Cryptocurrency" << endl;
+	cout << "C - Search for a Cryptocurrency by name" << endl;
+	cout << "D - Search for Cryptocurrencies by algorithm" << endl;
+	cout << "E - List the Cryptocurrencies in a range of names" << endl;
+	cout << "F - List data sorted by the primary key (name of the cryptocurrency)" << endl;
+	cout << "G - List data sorted by the secondary key (algorithm of the cryptocurrency)" << endl;
+	cout << "H - See the statistics of the shards" << endl;
+	cout << "I - Help to show the menu" << endl;
+	cout << "J - Exit" << endl;
+	cout << endl;
+}
+
+/*
+	read the whole file, then load the shards in parallel
+*/
+void loadShards(const string& filename, ShardedDatabase* database)
+{
+	ifstream inFile;
+	vector<Cryptocurrency*> coins;
+	Cryptocurrency* crypto;
+
+	inFile.open(filename);
+	if (!inFile)
+	{
+		cout << "Error opening the input file: \"" << filename << "\"" << endl;
+		exit(EXIT_FAILURE);
+	}
+	while ((crypto = readCrypto(inFile)) != nullptr)
+		coins.push_back(crypto);
+	inFile.close();
+
+	int inserted = database->insertMany(coins);
+	if (inserted < (int)coins.size())
+		cout << "Skipped " << coins.size() - inserted << " duplicate or too long names or algorithms" << endl;
+	cout << inserted << " Cryptocurrencies loaded into " << database->getShardCount() << " shards" << endl << endl;
+}
+
+/*
+	handle taking inputs and inserting into the shard of the name
+*/
+void shardInsertManager(ShardedDatabase* database)
+{
+	Cryptocurrency* crypto;
+	Cryptocurrency tmp;
+	string name, alg;
+
+	cout << "What is the name of the Cryptocurrency?" << endl;
+	getline(cin, name);
+	normalizeStr(name);
+
+	if (!FixedKey::fits(name))
+	{
+		cout << "The name can be at most " << FixedKey::CAPACITY << " characters long!" << endl;
+		return;
+	}
+
+	if (database->find(name, tmp))
+	{
+		cout << "The Cryptocurrency " + name + " already exists in shard " << database->shardOf(name) << "!" << endl;
+		return;
+	}
+
+	cout << "What is " << name << "'s Algorithm?" << endl;
+	getline(cin, alg);
+	trimSpaces(alg);
+
+	if (!FixedKey::fits(alg))
+	{
+		cout << "The algorithm can be at most " << FixedKey::CAPACITY << " characters long!" << endl;
+		return;
+	}
+
+	crypto = readCryptoDetails(name, alg);
+	if (!database->insert(crypto))
+	{
+		cout << "The Cryptocurrency " + name + " already exists!" << endl;
+		delete crypto;
+		return;
+	}
+	cout << "The Cryptocurrency " + name + " has been inserted into shard " << database->shardOf(name) << "!" << endl;
+	cout << endl;
+}
+
+/*
+	handle deleting a cryptocurrency from its shard
+*/
+void shardDeleteManager(ShardedDatabase* database)
+{
+	string name;
+	cout << "Enter the name of the Cryptocurrency you wish to delete" << endl;
+	getline(cin, name);
+	trimSpaces(name);
+	if (database->remove(name))
+		cout << name << " has been deleted from shard " << database->shardOf(name) << endl;
+	else
+		cout << NOT_FOUND << endl;
+}
+
+/*
+	handle searching by name, only the shard of the name is searched
+*/
+void shardNameSearchManager(ShardedDatabase* database)
+{
+	string name;
+	Cryptocurrency result;
+	cout << "Please input the name of the Cryptocurrency: " << endl;
+	getline(cin, name);
+	normalizeStr(name);
+	RowWriter row(cout);
+	printHeader(row);
+	if (database->find(name, result))
+		printCrypto(result, row);
+	else
+		row.put(NOT_FOUND).newline();
+	row.fill('=', 80).newline().newline();
+	row.flush();
+}
+
+/*
+	handle searching by algorithm in every shard
+*/
+void shardAlgSearchManager(ShardedDatabase* database)
+{
+	string alg;
+	vector<Cryptocurrency> cryptos;
+	cout << "Please input the algorithm of the Cryptocurrency: " << endl;
+	getline(cin, alg);
+	trimSpaces(alg);
+	database->findByAlg(alg, cryptos);
+	printCryptos(cryptos);
+}
+
+/*
+	handle listing the names from one name to another in every shard
+*/
+void shardRangeManager(ShardedDatabase* database)
+{
+	string first, last;
+	vector<Cryptocurrency> cryptos;
+	cout << "Please input the first name of the range: " << endl;
+	getline(cin, first);
+	trimSpaces(first);
+	cout << "Please input the last name of the range: " << endl;
+	getline(cin, last);
+	trimSpaces(last);
+	if (!FixedKey::fits(first) || !FixedKey::fits(last))
+	{
+		cout << "A name can be at most " << FixedKey::CAPACITY << " characters long!" << endl;
+		return;
+	}
+	database->rangeByName(first, last, cryptos);
+	printCryptos(cryptos);
+}
+
+/*
+	print a list of cryptocurrencies under the header
+*/
+void printCryptos(vector<Cryptocurrency>& cryptos)
+{
+	RowWriter row(cout);
+	printHeader(row);
+	if (cryptos.empty())
+		row.put(NOT_FOUND).newline();
+	for (Cryptocurrency& crypto : cryptos)
+		printCrypto(crypto, row);
+	row.fill('=', 80).newline().newline();
+	row.flush();
+}
+
+/*
+	print the coins and memory of each shard in a table format
+*/
+void printShardStats(ShardedDatabase* database)
+{
+	size_t totalBytes = 0;
+	int totalCoins = 0;
+	RowWriter row(cout);
+	row.newline().put("Statistics for the shards: ").newline();
+	row.fill('=', 80).newline();
+	row.left("Shard", 20).left("Entries", 15).left("Bytes", 15).newline();
+	row.fill('=', 80).newline();
+	for (int i = 0; i < database->getShardCount(); i++)
+	{
+		int coins = database->getShardSize(i);
+		size_t bytes = database->getShardMemory(i);
+		row.left(i, 20).left(coins, 15).left((long long)bytes, 15).newline();
+		totalCoins += coins;
+		totalBytes += bytes;
+	}
+	row.left("Total", 20).left(totalCoins, 15).left((long long)totalBytes, 15).newline();
+	row.fill('=', 80).newline();
+	row.flush();
+}
+
+/*
+	write the merged listing of the shards to the file
+*/
+void writeShardData(ShardedDatabase* database, const string& outFileName)
+{
+	vector<Cryptocurrency> cryptos;
+	ofstream textFile(outFileName.c_str());
+	if (!textFile.is_open())
+	{
+		cout << "Cannot open file: " + outFileName << endl;
+		return;
+	}
+	database->listByName(cryptos);
+	{
+		RowWriter out(textFile);
+		TextExporter exporter(out);
+		exporter.begin();
+		for (const Cryptocurrency& crypto : cryptos)
+			exporter.write(crypto);
+		exporter.end();
+	}
+	cout << "Data writen to " + outFileName << endl;
+	textFile.close();
+}
+
+/*
+	serve the sharded database on a Unix socket until interrupted,
+	then write the file like the menu's exit; nothing is written if
+	the server could not start
+*/
+int serverMain(const string& inputFileName, const string& socketPath, int shardCount)
+{
+	ShardedDatabase* database = new ShardedDatabase(shardCount, getNumberOfLines(inputFileName));
+	loadShards(inputFileName, database);
+
+	QueryServer* server = new QueryServer(*database, socketPath);
+	cout << "Serving on " << socketPath << ", press Ctrl-C to stop" << endl;
+	bool served = server->run();
+	if (served)
+		cout << "Server stopped after " << server->getRequestCount() << " requests" << endl;
+	else
+		cout << "Cannot serve: " << server->getError() << endl;
+	delete server;
+
+	if (served)
+		writeShardData(database, "SortedOutput.txt");
+	cout << "Deleting shards..." << endl;
+	delete database;
+	return served ? 0 : EXIT_FAILURE;
+}